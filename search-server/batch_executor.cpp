@@ -0,0 +1,162 @@
+#include "batch_executor.h"
+
+#include <algorithm>
+
+namespace {
+
+thread_local const BatchExecutor* current_executor = nullptr;
+thread_local size_t current_worker = 0;
+
+}
+
+thread_local BatchExecutor::Batch* BatchExecutor::current_batch_ = nullptr;
+
+BatchExecutor::BatchExecutor(size_t thread_count)
+    : workers_(std::max<size_t>(thread_count, 1)) {
+    threads_.reserve(workers_.size() - 1);
+    for (size_t worker = 1; worker < workers_.size(); ++worker) {
+        threads_.emplace_back([this, worker] {
+            WorkerLoop(worker);
+        });
+    }
+}
+
+BatchExecutor::~BatchExecutor() {
+    {
+        std::lock_guard guard(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+size_t BatchExecutor::GetThreadCount() const {
+    return workers_.size();
+}
+
+void BatchExecutor::Submit(Task task) {
+    const bool is_executor_thread = current_executor == this;
+    const size_t worker = is_executor_thread ? current_worker : next_worker_++ % workers_.size();
+    Batch& batch = is_executor_thread && current_batch_ ? *current_batch_ : GetCallerBatch();
+    batch.pending += 1;
+    {
+        std::lock_guard guard(workers_[worker].mutex);
+        workers_[worker].tasks.push_back({std::move(task), &batch});
+        queued_ += 1;
+    }
+    if (sleeping_ > 0) {
+        std::lock_guard guard(sleep_mutex_);
+        wake_.notify_one();
+    }
+}
+
+void BatchExecutor::Wait() {
+    Batch* batch;
+    {
+        std::lock_guard guard(batches_mutex_);
+        const auto it = batches_.find(std::this_thread::get_id());
+        if (it == batches_.end()) {
+            return;
+        }
+        batch = it->second.get();
+    }
+    const BatchExecutor* previous_executor = current_executor;
+    const size_t previous_worker = current_worker;
+    current_executor = this;
+    current_worker = 0;
+    while (batch->pending > 0) {
+        if (!TryRunTask(0)) {
+            Sleep([this, batch] {
+                return batch->pending == 0 || queued_ > 0;
+            });
+        }
+    }
+    current_executor = previous_executor;
+    current_worker = previous_worker;
+
+    std::exception_ptr exception;
+    {
+        std::lock_guard guard(batch->exception_mutex);
+        std::swap(exception, batch->exception);
+    }
+    {
+        std::lock_guard guard(batches_mutex_);
+        batches_.erase(std::this_thread::get_id());
+    }
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+void BatchExecutor::WorkerLoop(size_t worker) {
+    current_executor = this;
+    current_worker = worker;
+    while (!stopping_) {
+        if (!TryRunTask(worker)) {
+            Sleep([this] {
+                return stopping_ || queued_ > 0;
+            });
+        }
+    }
+}
+
+BatchExecutor::Batch& BatchExecutor::GetCallerBatch() {
+    std::lock_guard guard(batches_mutex_);
+    auto& batch = batches_[std::this_thread::get_id()];
+    if (!batch) {
+        batch = std::make_unique<Batch>();
+    }
+    return *batch;
+}
+
+bool BatchExecutor::TryRunTask(size_t worker) {
+    QueuedTask task{};
+    {
+        std::lock_guard guard(workers_[worker].mutex);
+        if (!workers_[worker].tasks.empty()) {
+            task = std::move(workers_[worker].tasks.back());
+            workers_[worker].tasks.pop_back();
+            queued_ -= 1;
+        }
+    }
+    for (size_t i = 1; !task.task && i < workers_.size(); ++i) {
+        auto& victim = workers_[(worker + i) % workers_.size()];
+        std::lock_guard guard(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued_ -= 1;
+        }
+    }
+    if (!task.task) {
+        return false;
+    }
+
+    Batch* const previous_batch = current_batch_;
+    current_batch_ = task.batch;
+    try {
+        task.task();
+    } catch (...) {
+        std::lock_guard guard(task.batch->exception_mutex);
+        if (!task.batch->exception) {
+            task.batch->exception = std::current_exception();
+        }
+    }
+    current_batch_ = previous_batch;
+    task.task = nullptr;
+
+    if (--task.batch->pending == 0) {
+        std::lock_guard guard(sleep_mutex_);
+        wake_.notify_all();
+    }
+    return true;
+}
+
+void BatchExecutor::Sleep(std::function<bool()> predicate) {
+    std::unique_lock lock(sleep_mutex_);
+    sleeping_ += 1;
+    wake_.wait(lock, predicate);
+    sleeping_ -= 1;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "cache_line.h"
+
+class BatchExecutor {
+public:
+    using Task = std::function<void()>;
+
+    explicit BatchExecutor(size_t thread_count = std::thread::hardware_concurrency());
+
+    ~BatchExecutor();
+
+    BatchExecutor(const BatchExecutor&) = delete;
+    BatchExecutor& operator=(const BatchExecutor&) = delete;
+
+    size_t GetThreadCount() const;
+
+    // Задачи, отправленные потоком, и порождённые ими задачи образуют его пакет.
+    // Wait ждёт только пакет вызывающего потока, поэтому исполнитель можно использовать из нескольких потоков.
+    void Submit(Task task);
+
+    void Wait();
+
+private:
+    struct Batch {
+        std::atomic<size_t> pending{0};
+        std::mutex exception_mutex;
+        std::exception_ptr exception;
+    };
+
+    struct QueuedTask {
+        Task task;
+        Batch* batch;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Worker {
+        std::mutex mutex;
+        std::deque<QueuedTask> tasks;
+    };
+
+    std::vector<Worker> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> next_worker_{0};
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> sleeping_{0};
+    std::atomic<bool> stopping_{false};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::mutex batches_mutex_;
+    std::map<std::thread::id, std::unique_ptr<Batch>> batches_;
+
+    static thread_local Batch* current_batch_;
+
+    Batch& GetCallerBatch();
+
+    void WorkerLoop(size_t worker);
+
+    bool TryRunTask(size_t worker);
+
+    void Sleep(std::function<bool()> predicate);
+};
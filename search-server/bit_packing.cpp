@@ -0,0 +1,84 @@
+#include "bit_packing.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const size_t LANE_COUNT = 4;
+
+size_t GroupCount(size_t count) {
+    return (count + LANE_COUNT - 1) / LANE_COUNT;
+}
+
+}
+
+uint8_t RequiredBits(uint32_t max_value) {
+    uint8_t bits = 0;
+    while (max_value != 0) {
+        ++bits;
+        max_value >>= 1;
+    }
+    return bits;
+}
+
+size_t PackedWordCount(size_t count, uint8_t bits) {
+    return LANE_COUNT * ((GroupCount(count) * bits + 31) / 32);
+}
+
+void PackBits(const uint32_t* values, size_t count, uint8_t bits, uint32_t* output) {
+    std::fill(output, output + PackedWordCount(count, bits), 0u);
+    if (bits == 0) {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const size_t lane = i % LANE_COUNT;
+        const size_t bit_position = (i / LANE_COUNT) * bits;
+        const size_t word = bit_position / 32;
+        const size_t shift = bit_position % 32;
+        output[LANE_COUNT * word + lane] |= values[i] << shift;
+        if (shift + bits > 32) {
+            output[LANE_COUNT * (word + 1) + lane] |= values[i] >> (32 - shift);
+        }
+    }
+}
+
+void UnpackBits(const uint32_t* input, size_t count, uint8_t bits, uint32_t* values) {
+    const size_t group_count = GroupCount(count);
+    if (bits == 0) {
+        std::fill(values, values + group_count * LANE_COUNT, 0u);
+        return;
+    }
+    const uint32_t mask = bits == 32 ? ~0u : (1u << bits) - 1;
+#if defined(__SSE2__)
+    const __m128i mask_vector = _mm_set1_epi32(static_cast<int>(mask));
+    for (size_t group = 0; group < group_count; ++group) {
+        const size_t bit_position = group * bits;
+        const size_t word = bit_position / 32;
+        const size_t shift = bit_position % 32;
+        const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + LANE_COUNT * word));
+        __m128i result = _mm_srl_epi32(low, _mm_cvtsi32_si128(static_cast<int>(shift)));
+        if (shift + bits > 32) {
+            const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + LANE_COUNT * (word + 1)));
+            result = _mm_or_si128(result, _mm_sll_epi32(high, _mm_cvtsi32_si128(static_cast<int>(32 - shift))));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + LANE_COUNT * group), _mm_and_si128(result, mask_vector));
+    }
+#else
+    for (size_t group = 0; group < group_count; ++group) {
+        const size_t bit_position = group * bits;
+        const size_t word = bit_position / 32;
+        const size_t shift = bit_position % 32;
+        for (size_t lane = 0; lane < LANE_COUNT; ++lane) {
+            uint32_t value = input[LANE_COUNT * word + lane] >> shift;
+            if (shift + bits > 32) {
+                value |= input[LANE_COUNT * (word + 1) + lane] << (32 - shift);
+            }
+            values[LANE_COUNT * group + lane] = value & mask;
+        }
+    }
+#endif
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+uint8_t RequiredBits(uint32_t max_value);
+
+size_t PackedWordCount(size_t count, uint8_t bits);
+
+void PackBits(const uint32_t* values, size_t count, uint8_t bits, uint32_t* output);
+
+void UnpackBits(const uint32_t* input, size_t count, uint8_t bits, uint32_t* values);
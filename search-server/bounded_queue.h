@@ -0,0 +1,57 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity)
+        : capacity_(capacity) {
+    }
+
+    bool Push(T value) {
+        std::unique_lock lock(mutex_);
+        not_full_.wait(lock, [this] {
+            return closed_ || items_.size() < capacity_;
+        });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(value));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    std::optional<T> Pop() {
+        std::unique_lock lock(mutex_);
+        not_empty_.wait(lock, [this] {
+            return closed_ || !items_.empty();
+        });
+        if (items_.empty()) {
+            return std::nullopt;
+        }
+        T value = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return value;
+    }
+
+    void Close() {
+        std::lock_guard lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+private:
+    const size_t capacity_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<T> items_;
+    bool closed_ = false;
+};
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <cstddef>
+
+const size_t CACHE_LINE_SIZE = 64;
@@ -0,0 +1,92 @@
+#include "collection_statistics.h"
+
+#include <cmath>
+
+CollectionStatistics::TermEntry::TermEntry(const TermEntry& other)
+    : document_freq(other.document_freq)
+    , generation(other.generation.load(std::memory_order_relaxed))
+    , inverse_document_freq(other.inverse_document_freq.load(std::memory_order_relaxed)) {
+}
+
+CollectionStatistics::TermEntry& CollectionStatistics::TermEntry::operator=(const TermEntry& other) {
+    document_freq = other.document_freq;
+    generation.store(other.generation.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    inverse_document_freq.store(other.inverse_document_freq.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return *this;
+}
+
+void CollectionStatistics::SetDocumentCount(int document_count) {
+    if (document_count != document_count_) {
+        document_count_ = document_count;
+        ++generation_;
+    }
+}
+
+int CollectionStatistics::GetDocumentCount() const {
+    return document_count_;
+}
+
+uint64_t CollectionStatistics::GetGeneration() const {
+    return generation_;
+}
+
+void CollectionStatistics::Reserve(size_t term_bound) {
+    if (terms_.size() < term_bound) {
+        terms_.resize(term_bound);
+    }
+}
+
+void CollectionStatistics::AddTerm(TermId term, uint32_t document_count) {
+    terms_[term].document_freq += document_count;
+    terms_[term].generation.store(0, std::memory_order_relaxed);
+}
+
+void CollectionStatistics::RemoveTerm(TermId term, uint32_t document_count) {
+    terms_[term].document_freq -= document_count;
+    terms_[term].generation.store(0, std::memory_order_relaxed);
+}
+
+uint32_t CollectionStatistics::GetDocumentFreq(TermId term) const {
+    return terms_[term].document_freq;
+}
+
+double CollectionStatistics::GetInverseDocumentFreq(TermId term) const {
+    const TermEntry& entry = terms_[term];
+    if (entry.generation.load(std::memory_order_acquire) == generation_) {
+        return entry.inverse_document_freq.load(std::memory_order_relaxed);
+    }
+    const double inverse_document_freq = std::log(document_count_ * 1.0 / entry.document_freq);
+    entry.inverse_document_freq.store(inverse_document_freq, std::memory_order_relaxed);
+    entry.generation.store(generation_, std::memory_order_release);
+    return inverse_document_freq;
+}
+
+TermStatistics CollectionStatistics::GetTermStatistics(TermId term) const {
+    if (term >= terms_.size() || terms_[term].document_freq == 0) {
+        return {};
+    }
+    return {terms_[term].document_freq, GetInverseDocumentFreq(term)};
+}
+
+void CollectionStatistics::Save(IndexFileWriter& writer) const {
+    std::vector<uint32_t> document_freqs(terms_.size());
+    for (size_t term = 0; term < terms_.size(); ++term) {
+        document_freqs[term] = terms_[term].document_freq;
+    }
+    writer.WriteValue<uint64_t>(document_freqs.size());
+    writer.WriteArray(document_freqs.data(), document_freqs.size());
+}
+
+CollectionStatistics CollectionStatistics::Load(IndexFileReader& reader, size_t term_bound) {
+    const uint64_t term_count = reader.ReadValue<uint64_t>();
+    if (term_count != term_bound) {
+        throw std::runtime_error("Некорректный формат индекса"s);
+    }
+    const uint32_t* document_freqs = reader.ReadArray<uint32_t>(term_count);
+    CollectionStatistics statistics;
+    statistics.Reserve(term_count);
+    for (size_t term = 0; term < term_count; ++term) {
+        statistics.terms_[term].document_freq = document_freqs[term];
+    }
+    return statistics;
+}
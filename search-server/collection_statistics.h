@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "index_file.h"
+#include "term_dictionary.h"
+
+struct TermStatistics {
+    uint32_t document_freq = 0;
+    double inverse_document_freq = 0.0;
+};
+
+class CollectionStatistics {
+public:
+    void SetDocumentCount(int document_count);
+
+    int GetDocumentCount() const;
+
+    uint64_t GetGeneration() const;
+
+    void Reserve(size_t term_bound);
+
+    void AddTerm(TermId term, uint32_t document_count = 1);
+
+    void RemoveTerm(TermId term, uint32_t document_count = 1);
+
+    uint32_t GetDocumentFreq(TermId term) const;
+
+    double GetInverseDocumentFreq(TermId term) const;
+
+    TermStatistics GetTermStatistics(TermId term) const;
+
+    void Save(IndexFileWriter& writer) const;
+
+    static CollectionStatistics Load(IndexFileReader& reader, size_t term_bound);
+
+private:
+    struct TermEntry {
+        uint32_t document_freq = 0;
+        mutable std::atomic<uint64_t> generation{0};
+        mutable std::atomic<double> inverse_document_freq{0.0};
+
+        TermEntry() = default;
+
+        TermEntry(const TermEntry& other);
+
+        TermEntry& operator=(const TermEntry& other);
+    };
+
+    std::vector<TermEntry> terms_;
+    int document_count_ = 0;
+    uint64_t generation_ = 1;
+};
@@ -1,56 +1,232 @@
 #pragma once
 
-#include <cstdlib>
+#include <algorithm>
+#include <cstdint>
+#include <execution>
+#include <functional>
+#include <iterator>
 #include <map>
 #include <mutex>
+#include <optional>
+#include <tuple>
+#include <utility>
 #include <vector>
 
-using namespace std::string_literals;
+#include "cache_line.h"
 
-template <typename Key, typename Value>
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
 class ConcurrentMap {
 private:
-    struct Bucket {
-        std::mutex mutex;
-        std::map<Key, Value> map;
+    enum class SlotState : uint8_t {
+        EMPTY,
+        FULL,
+        ERASED,
     };
 
-public:
-    static_assert(std::is_integral_v<Key>, "ConcurrentMap supports only integer keys"s);
+    class Table {
+    public:
+        Value& Get(const Key& key, uint64_t hash) {
+            if ((used_ + 1) * 4 > states_.size() * 3) {
+                Rehash();
+            }
+            const size_t mask = states_.size() - 1;
+            size_t free_slot = states_.size();
+            for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+                if (states_[slot] == SlotState::FULL) {
+                    if (hashes_[slot] == hash && entries_[slot]->first == key) {
+                        return entries_[slot]->second;
+                    }
+                } else if (states_[slot] == SlotState::ERASED) {
+                    if (free_slot == states_.size()) {
+                        free_slot = slot;
+                    }
+                } else {
+                    if (free_slot == states_.size()) {
+                        free_slot = slot;
+                        ++used_;
+                    }
+                    break;
+                }
+            }
+            states_[free_slot] = SlotState::FULL;
+            hashes_[free_slot] = hash;
+            entries_[free_slot].emplace(std::piecewise_construct, std::forward_as_tuple(key), std::tuple<>());
+            ++size_;
+            return entries_[free_slot]->second;
+        }
+
+        bool Erase(const Key& key, uint64_t hash) {
+            if (size_ == 0) {
+                return false;
+            }
+            const size_t mask = states_.size() - 1;
+            for (size_t slot = hash & mask; states_[slot] != SlotState::EMPTY; slot = (slot + 1) & mask) {
+                if (states_[slot] == SlotState::FULL && hashes_[slot] == hash && entries_[slot]->first == key) {
+                    states_[slot] = SlotState::ERASED;
+                    entries_[slot].reset();
+                    --size_;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        template <typename Func>
+        void ForEach(Func& func) const {
+            for (size_t slot = 0; slot < states_.size(); ++slot) {
+                if (states_[slot] == SlotState::FULL) {
+                    func(entries_[slot]->first, entries_[slot]->second);
+                }
+            }
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+    private:
+        // Пустые слоты не хранят ключ и значение, поэтому от типов не требуется конструктор по умолчанию
+        std::vector<std::optional<std::pair<Key, Value>>> entries_;
+        std::vector<uint64_t> hashes_;
+        std::vector<SlotState> states_;
+        size_t size_ = 0;
+        size_t used_ = 0;
+
+        void Rehash() {
+            size_t capacity = 16;
+            while (capacity < (size_ + 1) * 2) {
+                capacity *= 2;
+            }
+            std::vector<std::optional<std::pair<Key, Value>>> entries(capacity);
+            std::vector<uint64_t> hashes(capacity);
+            std::vector<SlotState> states(capacity, SlotState::EMPTY);
+            std::swap(entries, entries_);
+            std::swap(hashes, hashes_);
+            std::swap(states, states_);
+            used_ = size_;
+            const size_t mask = capacity - 1;
+            for (size_t slot = 0; slot < states.size(); ++slot) {
+                if (states[slot] != SlotState::FULL) {
+                    continue;
+                }
+                size_t target = hashes[slot] & mask;
+                while (states_[target] == SlotState::FULL) {
+                    target = (target + 1) & mask;
+                }
+                states_[target] = SlotState::FULL;
+                hashes_[target] = hashes[slot];
+                entries_[target].emplace(std::move(*entries[slot]));
+            }
+        }
+    };
 
+    struct alignas(CACHE_LINE_SIZE) Bucket {
+        mutable std::mutex mutex;
+        Table table;
+    };
+
+public:
     struct Access {
         std::lock_guard<std::mutex> guard;
         Value& ref_to_value;
 
-        Access(const Key& key, Bucket& bucket)
+        Access(const Key& key, uint64_t hash, Bucket& bucket)
             : guard(bucket.mutex)
-            , ref_to_value(bucket.map[key]) {
+            , ref_to_value(bucket.table.Get(key, hash)) {
         }
     };
 
     explicit ConcurrentMap(size_t bucket_count)
-        : buckets_(bucket_count) {
+        : buckets_(std::max<size_t>(bucket_count, 1)) {
     }
 
     Access operator[](const Key& key) {
-        auto& bucket = buckets_[static_cast<uint64_t>(key) % buckets_.size()];
-        return {key, bucket};
+        const uint64_t hash = Mix(hasher_(key));
+        return {key, hash, GetBucket(hash)};
     }
 
-    std::map<Key, Value> BuildOrdinaryMap() {
-        std::map<Key, Value> result;
-        for (auto& [mutex, map] : buckets_) {
-            std::lock_guard g(mutex);
-            result.insert(map.begin(), map.end());
+    void erase(const Key& key) {
+        const uint64_t hash = Mix(hasher_(key));
+        auto& bucket = GetBucket(hash);
+        std::lock_guard g(bucket.mutex);
+        bucket.table.Erase(key, hash);
+    }
+
+    size_t size() const {
+        size_t result = 0;
+        for (const auto& bucket : buckets_) {
+            std::lock_guard g(bucket.mutex);
+            result += bucket.table.size();
         }
         return result;
     }
-    
-    void erase(const Key& key) {
-        auto& bucket = buckets_[static_cast<uint64_t>(key) % buckets_.size()];
-        bucket.map.erase(key);
+
+    template <typename Func>
+    void ForEach(Func func) const {
+        for (const auto& bucket : buckets_) {
+            std::lock_guard g(bucket.mutex);
+            bucket.table.ForEach(func);
+        }
+    }
+
+    template <class ExecutionPolicy>
+    std::vector<std::pair<Key, Value>> BuildVector(ExecutionPolicy&& policy) const {
+        std::vector<std::unique_lock<std::mutex>> locks;
+        locks.reserve(buckets_.size());
+        size_t total_size = 0;
+        for (size_t i = 0; i < buckets_.size(); ++i) {
+            locks.emplace_back(buckets_[i].mutex);
+            total_size += buckets_[i].table.size();
+        }
+        std::vector<std::vector<std::pair<Key, Value>>> parts(buckets_.size());
+        std::for_each(policy, buckets_.begin(), buckets_.end(), [&](const Bucket& bucket) {
+            auto& part = parts[&bucket - buckets_.data()];
+            part.reserve(bucket.table.size());
+            auto copy = [&part](const Key& key, const Value& value) {
+                part.emplace_back(key, value);
+            };
+            bucket.table.ForEach(copy);
+        });
+        std::vector<std::pair<Key, Value>> result;
+        result.reserve(total_size);
+        for (auto& part : parts) {
+            result.insert(result.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+        }
+        return result;
+    }
+
+    template <class ExecutionPolicy>
+    std::vector<std::pair<Key, Value>> BuildSortedVector(ExecutionPolicy&& policy) const {
+        auto result = BuildVector(policy);
+        std::sort(policy, result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.first < rhs.first;
+        });
+        return result;
+    }
+
+    std::map<Key, Value> BuildOrdinaryMap() const {
+        const auto entries = BuildSortedVector(std::execution::seq);
+        std::map<Key, Value> result;
+        for (const auto& entry : entries) {
+            result.emplace_hint(result.end(), entry);
+        }
+        return result;
     }
 
 private:
+    Hash hasher_;
     std::vector<Bucket> buckets_;
-};
\ No newline at end of file
+
+    static uint64_t Mix(uint64_t hash) {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    Bucket& GetBucket(uint64_t hash) {
+        return buckets_[(hash >> 32) % buckets_.size()];
+    }
+};
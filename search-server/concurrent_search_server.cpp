@@ -0,0 +1,129 @@
+#include "concurrent_search_server.h"
+
+#include <algorithm>
+
+ConcurrentSearchServer::Snapshot::Snapshot(Version* version)
+    : version_(version) {
+}
+
+ConcurrentSearchServer::Snapshot::Snapshot(Snapshot&& other) noexcept
+    : version_(std::exchange(other.version_, nullptr)) {
+}
+
+ConcurrentSearchServer::Snapshot& ConcurrentSearchServer::Snapshot::operator=(Snapshot&& other) noexcept {
+    if (this != &other) {
+        if (version_) {
+            --version_->readers;
+        }
+        version_ = std::exchange(other.version_, nullptr);
+    }
+    return *this;
+}
+
+ConcurrentSearchServer::Snapshot::~Snapshot() {
+    if (version_) {
+        --version_->readers;
+    }
+}
+
+const SearchServer& ConcurrentSearchServer::Snapshot::operator*() const {
+    return *version_->server;
+}
+
+const SearchServer* ConcurrentSearchServer::Snapshot::operator->() const {
+    return version_->server.get();
+}
+
+ConcurrentSearchServer::ConcurrentSearchServer(const std::string& stop_words_text)
+    : ConcurrentSearchServer(SplitIntoWords(stop_words_text)) {
+}
+
+ConcurrentSearchServer::ConcurrentSearchServer(const std::string_view stop_words_text)
+    : ConcurrentSearchServer(SplitIntoWords(stop_words_text)) {
+}
+
+ConcurrentSearchServer::Snapshot ConcurrentSearchServer::GetSnapshot() const {
+    while (true) {
+        Version* version = published_;
+        ++version->readers;
+        if (published_ == version) {
+            return Snapshot(version);
+        }
+        --version->readers;
+    }
+}
+
+void ConcurrentSearchServer::AddDocument(int document_id, const std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+    Write({true, document_id, std::string(document), status, ratings});
+}
+
+void ConcurrentSearchServer::RemoveDocument(int document_id) {
+    Write({false, document_id, {}, DocumentStatus::ACTUAL, {}});
+}
+
+void ConcurrentSearchServer::Publish() {
+    std::lock_guard guard(writer_mutex_);
+    Version* retired = published_;
+    if (draft_->applied_operations == retired->applied_operations) {
+        return;
+    }
+    published_ = draft_;
+
+    draft_ = nullptr;
+    for (const auto& version : versions_) {
+        if (version.get() == published_ || version->readers > 0) {
+            continue;
+        }
+        if (!draft_ || version->applied_operations < draft_->applied_operations) {
+            draft_ = version.get();
+        }
+    }
+    if (!draft_) {
+        versions_.push_back(std::make_unique<Version>());
+        draft_ = versions_.back().get();
+    }
+    if (!draft_->server || draft_->applied_operations < first_operation_) {
+        const Version& source = *published_.load();
+        draft_->server = std::make_unique<SearchServer>(*source.server);
+        draft_->applied_operations = source.applied_operations;
+    }
+    CatchUp(*draft_);
+
+    size_t oldest_operation = draft_->applied_operations;
+    for (const auto& version : versions_) {
+        if (version.get() == retired || version->readers == 0) {
+            oldest_operation = std::min(oldest_operation, version->applied_operations);
+        }
+    }
+    while (first_operation_ < oldest_operation) {
+        operations_.pop_front();
+        ++first_operation_;
+    }
+}
+
+size_t ConcurrentSearchServer::GetOperationLogSize() const {
+    std::lock_guard guard(writer_mutex_);
+    return operations_.size();
+}
+
+void ConcurrentSearchServer::Write(Operation operation) {
+    std::lock_guard guard(writer_mutex_);
+    Apply(*draft_->server, operation);
+    operations_.push_back(std::move(operation));
+    ++draft_->applied_operations;
+}
+
+void ConcurrentSearchServer::CatchUp(Version& version) {
+    while (version.applied_operations < first_operation_ + operations_.size()) {
+        Apply(*version.server, operations_[version.applied_operations - first_operation_]);
+        ++version.applied_operations;
+    }
+}
+
+void ConcurrentSearchServer::Apply(SearchServer& server, const Operation& operation) {
+    if (operation.is_add) {
+        server.AddDocument(operation.document_id, operation.document, operation.status, operation.ratings);
+    } else {
+        server.RemoveDocument(operation.document_id);
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "document.h"
+#include "search_server.h"
+#include "cache_line.h"
+
+class ConcurrentSearchServer {
+private:
+    struct alignas(CACHE_LINE_SIZE) Version {
+        std::unique_ptr<SearchServer> server;
+        std::atomic<size_t> readers{0};
+        size_t applied_operations = 0;
+    };
+
+public:
+    class Snapshot {
+    public:
+        Snapshot(Snapshot&& other) noexcept;
+
+        Snapshot& operator=(Snapshot&& other) noexcept;
+
+        ~Snapshot();
+
+        const SearchServer& operator*() const;
+
+        const SearchServer* operator->() const;
+
+    private:
+        friend class ConcurrentSearchServer;
+
+        explicit Snapshot(Version* version);
+
+        Version* version_;
+    };
+
+    template <typename StringContainer>
+    explicit ConcurrentSearchServer(const StringContainer& stop_words);
+    explicit ConcurrentSearchServer(const std::string& stop_words_text);
+    explicit ConcurrentSearchServer(const std::string_view stop_words_text);
+
+    Snapshot GetSnapshot() const;
+
+    void AddDocument(int document_id, const std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+
+    void RemoveDocument(int document_id);
+
+    void Publish();
+
+    size_t GetOperationLogSize() const;
+
+private:
+    struct Operation {
+        bool is_add;
+        int document_id;
+        std::string document;
+        DocumentStatus status;
+        std::vector<int> ratings;
+    };
+
+    std::vector<std::unique_ptr<Version>> versions_;
+    std::atomic<Version*> published_;
+    Version* draft_;
+    mutable std::mutex writer_mutex_;
+    std::deque<Operation> operations_;
+    size_t first_operation_ = 0;
+
+    void Write(Operation operation);
+
+    void CatchUp(Version& version);
+
+    static void Apply(SearchServer& server, const Operation& operation);
+};
+
+template <typename StringContainer>
+ConcurrentSearchServer::ConcurrentSearchServer(const StringContainer& stop_words) {
+    for (int i = 0; i < 2; ++i) {
+        versions_.push_back(std::make_unique<Version>());
+        versions_.back()->server = std::make_unique<SearchServer>(stop_words);
+    }
+    published_ = versions_[0].get();
+    draft_ = versions_[1].get();
+}
@@ -1,5 +1,7 @@
 #include "document.h"
 
+#include <algorithm>
+
 Document::Document(int id, double relevance, int rating) : id(id), relevance(relevance), rating(rating) {
     }
     
@@ -9,4 +11,18 @@ Document::Document(int id, double relevance, int rating) : id(id), relevance(rel
     << "relevance = "s << document.relevance << ", "s
     << "rating = "s << document.rating << " }"s;
     return output;
-}
\ No newline at end of file
+}
+bool operator==(const DocumentSignature& lhs, const DocumentSignature& rhs) {
+    return lhs.low == rhs.low && lhs.high == rhs.high;
+}
+
+size_t DocumentSignatureHasher::operator()(const DocumentSignature& signature) const {
+    return static_cast<size_t>(signature.low ^ (signature.high >> 17));
+}
+
+bool DocumentFilter::operator()(int document_id, DocumentStatus document_status, int rating) const {
+    if (rating < min_rating || rating > max_rating || document_id < min_document_id || document_id > max_document_id) {
+        return false;
+    }
+    return statuses.empty() || std::find(statuses.begin(), statuses.end(), document_status) != statuses.end();
+}
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <string_view>
+#include <vector>
 
 using std::literals::string_literals::operator""s;
 
@@ -22,6 +27,51 @@ enum class DocumentStatus {
     REMOVED,
 };
 
+const size_t DOCUMENT_STATUS_COUNT = 4;
+
+struct DocumentStatusFilter {
+    DocumentStatus status;
+
+    bool operator()(int, DocumentStatus document_status, int) const {
+        return document_status == status;
+    }
+};
+
+struct AnyDocumentFilter {
+    bool operator()(int, DocumentStatus, int) const {
+        return true;
+    }
+};
+
+struct DocumentFilter {
+    int min_rating = std::numeric_limits<int>::min();
+    int max_rating = std::numeric_limits<int>::max();
+    int min_document_id = 0;
+    int max_document_id = std::numeric_limits<int>::max();
+    // пустой список означает любой статус
+    std::vector<DocumentStatus> statuses;
+
+    bool operator()(int document_id, DocumentStatus document_status, int rating) const;
+};
+
+struct DocumentInput {
+    int id;
+    std::string_view text;
+    DocumentStatus status;
+    std::vector<int> ratings;
+};
+
+struct DocumentSignature {
+    uint64_t low = 0;
+    uint64_t high = 0;
+};
+
+bool operator==(const DocumentSignature& lhs, const DocumentSignature& rhs);
+
+struct DocumentSignatureHasher {
+    size_t operator()(const DocumentSignature& signature) const;
+};
+
 std::ostream& operator<<(std::ostream& output, Document document);
 
 
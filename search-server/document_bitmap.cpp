@@ -0,0 +1,25 @@
+#include "document_bitmap.h"
+
+void DocumentBitmap::Set(int document_index) {
+    const size_t word = static_cast<size_t>(document_index) / 64;
+    if (word >= words_.size()) {
+        words_.resize(word + 1);
+    }
+    const uint64_t mask = uint64_t{1} << (document_index % 64);
+    count_ += (words_[word] & mask) == 0;
+    words_[word] |= mask;
+}
+
+void DocumentBitmap::Reset(int document_index) {
+    const size_t word = static_cast<size_t>(document_index) / 64;
+    if (word >= words_.size()) {
+        return;
+    }
+    const uint64_t mask = uint64_t{1} << (document_index % 64);
+    count_ -= (words_[word] & mask) != 0;
+    words_[word] &= ~mask;
+}
+
+size_t DocumentBitmap::count() const {
+    return count_;
+}
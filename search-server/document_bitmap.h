@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class DocumentBitmap {
+public:
+    void Set(int document_index);
+
+    void Reset(int document_index);
+
+    bool Test(int document_index) const {
+        const size_t word = static_cast<size_t>(document_index) / 64;
+        return word < words_.size() && (words_[word] >> (document_index % 64) & 1);
+    }
+
+    uint64_t GetWord(size_t word) const {
+        return word < words_.size() ? words_[word] : 0;
+    }
+
+    size_t count() const;
+
+private:
+    std::vector<uint64_t> words_;
+    size_t count_ = 0;
+};
@@ -0,0 +1,254 @@
+#include "document_loader.h"
+
+#include <charconv>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+#include "bounded_queue.h"
+#include "index_file.h"
+
+using std::literals::string_literals::operator""s;
+
+namespace {
+
+struct Chunk {
+    std::shared_ptr<const void> owner;
+    std::string_view text;
+};
+
+struct Batch {
+    std::vector<std::shared_ptr<const void>> owners;
+    std::vector<DocumentInput> documents;
+    std::vector<SearchServer::TokenizedDocument> tokenized_documents;
+    std::vector<size_t> line_numbers;
+    std::vector<LoadError> errors;
+};
+
+using ChunkProducer = std::function<bool(Chunk&)>;
+
+bool NextField(std::string_view& line, std::string_view& field) {
+    const size_t tab = line.find('\t');
+    if (tab == line.npos) {
+        return false;
+    }
+    field = line.substr(0, tab);
+    line.remove_prefix(tab + 1);
+    return true;
+}
+
+bool ParseInt(std::string_view text, int& value) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+bool ParseStatus(std::string_view text, DocumentStatus& status) {
+    static const std::string_view STATUS_NAMES[] = {"ACTUAL", "IRRELEVANT", "BANNED", "REMOVED"};
+    for (int i = 0; i < 4; ++i) {
+        if (text == STATUS_NAMES[i] || (text.size() == 1 && text[0] == '0' + i)) {
+            status = static_cast<DocumentStatus>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string ParseRecord(std::string_view line, DocumentInput& document) {
+    std::string_view id;
+    std::string_view status;
+    std::string_view ratings;
+    if (!NextField(line, id) || !NextField(line, status) || !NextField(line, ratings)) {
+        return "Некорректный формат записи"s;
+    }
+    if (!ParseInt(id, document.id)) {
+        return "Некорректный ID"s;
+    }
+    if (document.id < 0) {
+        return "ID не может быть отрицательным"s;
+    }
+    if (!ParseStatus(status, document.status)) {
+        return "Некорректный статус"s;
+    }
+    document.ratings.clear();
+    while (!ratings.empty()) {
+        const size_t space = ratings.find(' ');
+        const std::string_view rating = ratings.substr(0, space);
+        ratings.remove_prefix(space == ratings.npos ? ratings.size() : space + 1);
+        if (rating.empty()) {
+            continue;
+        }
+        if (!ParseInt(rating, document.ratings.emplace_back())) {
+            return "Некорректный рейтинг"s;
+        }
+    }
+    if (!IsValidWord(line)) {
+        return "Некорректный ввод"s;
+    }
+    document.text = line;
+    return {};
+}
+
+void ParseChunks(const SearchServer& search_server, const ChunkProducer& produce, BoundedQueue<Batch>& batches) {
+    Batch batch;
+    size_t line_number = 0;
+    Chunk chunk;
+    while (produce(chunk)) {
+        batch.owners.push_back(chunk.owner);
+        std::string_view text = chunk.text;
+        while (!text.empty()) {
+            const size_t end = text.find('\n');
+            std::string_view line = text.substr(0, end);
+            text.remove_prefix(end == text.npos ? text.size() : end + 1);
+            ++line_number;
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            if (line.empty()) {
+                continue;
+            }
+            DocumentInput document{};
+            if (std::string error = ParseRecord(line, document); !error.empty()) {
+                batch.errors.push_back({line_number, std::move(error)});
+                continue;
+            }
+            batch.tokenized_documents.push_back(search_server.TokenizeDocument(document.text));
+            batch.documents.push_back(std::move(document));
+            batch.line_numbers.push_back(line_number);
+            if (batch.documents.size() == LOADER_BATCH_SIZE) {
+                if (!batches.Push(std::move(batch))) {
+                    return;
+                }
+                batch = Batch{};
+                batch.owners.push_back(chunk.owner);
+            }
+        }
+    }
+    if (!batch.documents.empty() || !batch.errors.empty()) {
+        batches.Push(std::move(batch));
+    }
+}
+
+void IndexBatch(SearchServer& search_server, Batch& batch, LoadReport& report) {
+    report.errors.insert(report.errors.end(), batch.errors.begin(), batch.errors.end());
+    try {
+        search_server.AddDocuments(std::execution::par, batch.documents, std::move(batch.tokenized_documents));
+        report.document_count += batch.documents.size();
+        return;
+    } catch (const std::invalid_argument&) {
+    }
+    for (size_t i = 0; i < batch.documents.size(); ++i) {
+        const DocumentInput& document = batch.documents[i];
+        try {
+            search_server.AddDocument(document.id, document.text, document.status, document.ratings);
+            ++report.document_count;
+        } catch (const std::invalid_argument& e) {
+            report.errors.push_back({batch.line_numbers[i], e.what()});
+        }
+    }
+}
+
+LoadReport RunPipeline(SearchServer& search_server, const ChunkProducer& produce) {
+    BoundedQueue<Chunk> chunks(LOADER_QUEUE_CAPACITY);
+    BoundedQueue<Batch> batches(LOADER_QUEUE_CAPACITY);
+    std::exception_ptr reader_exception;
+    std::exception_ptr parser_exception;
+    std::thread reader([&] {
+        try {
+            Chunk chunk;
+            while (produce(chunk) && chunks.Push(std::move(chunk))) {
+            }
+        } catch (...) {
+            reader_exception = std::current_exception();
+        }
+        chunks.Close();
+    });
+    std::thread parser([&] {
+        try {
+            ParseChunks(search_server, [&chunks](Chunk& chunk) {
+                std::optional<Chunk> next = chunks.Pop();
+                if (next) {
+                    chunk = std::move(*next);
+                }
+                return next.has_value();
+            }, batches);
+        } catch (...) {
+            parser_exception = std::current_exception();
+        }
+        chunks.Close();
+        batches.Close();
+    });
+
+    LoadReport report;
+    std::exception_ptr indexer_exception;
+    try {
+        while (std::optional<Batch> batch = batches.Pop()) {
+            IndexBatch(search_server, *batch, report);
+        }
+    } catch (...) {
+        indexer_exception = std::current_exception();
+    }
+    chunks.Close();
+    batches.Close();
+    reader.join();
+    parser.join();
+    for (const std::exception_ptr& exception : {reader_exception, parser_exception, indexer_exception}) {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+    return report;
+}
+
+}
+
+LoadReport LoadDocuments(SearchServer& search_server, const std::string& path) {
+    const std::shared_ptr<const MappedFile> file = MappedFile::Open(path);
+    size_t position = 0;
+    return RunPipeline(search_server, [&file, &position](Chunk& chunk) {
+        if (position == file->size()) {
+            return false;
+        }
+        const std::string_view rest(file->data() + position, file->size() - position);
+        size_t end = rest.size();
+        if (end > LOADER_CHUNK_SIZE) {
+            const size_t newline = rest.find('\n', LOADER_CHUNK_SIZE);
+            end = newline == rest.npos ? rest.size() : newline + 1;
+        }
+        chunk = {file, rest.substr(0, end)};
+        position += end;
+        return true;
+    });
+}
+
+LoadReport LoadDocuments(SearchServer& search_server, std::istream& input) {
+    std::string carry;
+    return RunPipeline(search_server, [&input, &carry](Chunk& chunk) {
+        if (!input && carry.empty()) {
+            return false;
+        }
+        auto buffer = std::make_shared<std::string>(std::move(carry));
+        carry.clear();
+        size_t size = buffer->size();
+        buffer->resize(size + LOADER_CHUNK_SIZE);
+        if (input) {
+            input.read(buffer->data() + size, LOADER_CHUNK_SIZE);
+            size += static_cast<size_t>(input.gcount());
+            if (input.bad()) {
+                throw std::runtime_error("Ошибка чтения входных данных"s);
+            }
+        }
+        buffer->resize(size);
+        if (input) {
+            const size_t newline = buffer->rfind('\n');
+            const size_t end = newline == buffer->npos ? 0 : newline + 1;
+            carry.assign(*buffer, end, buffer->npos);
+            buffer->resize(end);
+        }
+        chunk = {buffer, *buffer};
+        return true;
+    });
+}
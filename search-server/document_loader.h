@@ -0,0 +1,25 @@
+#pragma once
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "search_server.h"
+
+const size_t LOADER_CHUNK_SIZE = 1 << 22;
+const size_t LOADER_BATCH_SIZE = 1 << 12;
+const size_t LOADER_QUEUE_CAPACITY = 4;
+
+struct LoadError {
+    size_t line_number;
+    std::string message;
+};
+
+struct LoadReport {
+    size_t document_count = 0;
+    std::vector<LoadError> errors;
+};
+
+LoadReport LoadDocuments(SearchServer& search_server, const std::string& path);
+
+LoadReport LoadDocuments(SearchServer& search_server, std::istream& input);
@@ -0,0 +1,149 @@
+#include "forward_index.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using std::literals::string_literals::operator""s;
+
+void ForwardIndex::Add(int document_index, const std::vector<DocumentTerm>& terms) {
+    if (offsets_.size() <= static_cast<size_t>(document_index)) {
+        offsets_.resize(document_index + 1, terms_.size());
+        sizes_.resize(document_index + 1);
+    }
+    offsets_[document_index] = terms_.size();
+    sizes_[document_index] = static_cast<uint32_t>(terms.size());
+    terms_.insert(terms_.end(), terms.begin(), terms.end());
+}
+
+void ForwardIndex::Remove(int document_index) {
+    garbage_size_ += sizes_[document_index];
+    sizes_[document_index] = 0;
+    if (garbage_size_ * 2 > terms_.size()) {
+        Compact();
+    }
+}
+
+void ForwardIndex::Renumber(const std::vector<int>& new_indices, size_t document_count) {
+    Compact();
+    for (size_t document_index = 0; document_index < new_indices.size(); ++document_index) {
+        if (new_indices[document_index] >= 0) {
+            offsets_[new_indices[document_index]] = offsets_[document_index];
+            sizes_[new_indices[document_index]] = sizes_[document_index];
+        }
+    }
+    offsets_.resize(document_count);
+    offsets_.shrink_to_fit();
+    sizes_.resize(document_count);
+    sizes_.shrink_to_fit();
+}
+
+DocumentTerms ForwardIndex::Get(int document_index) const {
+    const DocumentTerm* first = terms_.data() + offsets_[document_index];
+    return {first, first + sizes_[document_index]};
+}
+
+void ForwardIndex::Save(IndexFileWriter& writer) const {
+    std::vector<DocumentTerm> terms;
+    terms.reserve(terms_.size() - garbage_size_);
+    for (size_t document_index = 0; document_index < sizes_.size(); ++document_index) {
+        const DocumentTerms document_terms = Get(static_cast<int>(document_index));
+        terms.insert(terms.end(), document_terms.begin(), document_terms.end());
+    }
+    writer.WriteValue<uint64_t>(sizes_.size());
+    writer.WriteArray(sizes_.data(), sizes_.size());
+    writer.WriteValue<uint64_t>(terms.size());
+    writer.WriteArray(terms.data(), terms.size());
+}
+
+ForwardIndex ForwardIndex::Load(IndexFileReader& reader, size_t document_count) {
+    if (reader.ReadValue<uint64_t>() != document_count) {
+        throw std::runtime_error("Некорректный формат индекса"s);
+    }
+    const uint32_t* sizes = reader.ReadArray<uint32_t>(document_count);
+    const uint64_t term_count = reader.ReadValue<uint64_t>();
+    const DocumentTerm* terms = reader.ReadArray<DocumentTerm>(term_count);
+    ForwardIndex index;
+    index.terms_.assign(terms, terms + term_count);
+    index.sizes_.assign(sizes, sizes + document_count);
+    index.offsets_.resize(document_count);
+    uint64_t offset = 0;
+    for (size_t document_index = 0; document_index < document_count; ++document_index) {
+        index.offsets_[document_index] = offset;
+        offset += sizes[document_index];
+        if (offset > term_count) {
+            throw std::runtime_error("Некорректный формат индекса"s);
+        }
+    }
+    if (offset != term_count) {
+        throw std::runtime_error("Некорректный формат индекса"s);
+    }
+    return index;
+}
+
+void ForwardIndex::Compact() {
+    std::vector<DocumentTerm> terms;
+    terms.reserve(terms_.size() - garbage_size_);
+    for (size_t document_index = 0; document_index < sizes_.size(); ++document_index) {
+        const DocumentTerms document_terms = Get(static_cast<int>(document_index));
+        offsets_[document_index] = terms.size();
+        terms.insert(terms.end(), document_terms.begin(), document_terms.end());
+    }
+    terms_ = std::move(terms);
+    garbage_size_ = 0;
+}
+
+WordFrequencies::WordFrequencies()
+    : terms_(nullptr, nullptr) {
+}
+
+WordFrequencies::WordFrequencies(const TermDictionary& dictionary, DocumentTerms terms, double inv_word_count)
+    : dictionary_(&dictionary)
+    , terms_(terms)
+    , inv_word_count_(inv_word_count) {
+}
+
+WordFrequencies::const_iterator WordFrequencies::begin() const {
+    return {this, terms_.begin()};
+}
+
+WordFrequencies::const_iterator WordFrequencies::end() const {
+    return {this, terms_.end()};
+}
+
+size_t WordFrequencies::size() const {
+    return terms_.size();
+}
+
+bool WordFrequencies::empty() const {
+    return terms_.size() == 0;
+}
+
+double WordFrequencies::at(std::string_view word) const {
+    const TermId term = dictionary_ ? dictionary_->Find(word) : TermDictionary::NO_TERM;
+    const DocumentTerm* it = std::lower_bound(terms_.begin(), terms_.end(), term, [](const DocumentTerm& document_term, TermId value) {
+        return document_term.term < value;
+    });
+    if (term == TermDictionary::NO_TERM || it == terms_.end() || it->term != term) {
+        throw std::out_of_range("Нет такого слова"s);
+    }
+    return it->term_count * inv_word_count_;
+}
+
+DocumentTerms WordFrequencies::GetTerms() const {
+    return terms_;
+}
+
+bool operator==(const WordFrequencies& lhs, const WordFrequencies& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    std::vector<std::pair<std::string_view, double>> lhs_words(lhs.begin(), lhs.end());
+    std::vector<std::pair<std::string_view, double>> rhs_words(rhs.begin(), rhs.end());
+    std::sort(lhs_words.begin(), lhs_words.end());
+    std::sort(rhs_words.begin(), rhs_words.end());
+    return lhs_words == rhs_words;
+}
+
+bool operator!=(const WordFrequencies& lhs, const WordFrequencies& rhs) {
+    return !(lhs == rhs);
+}
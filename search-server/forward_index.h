@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "index_file.h"
+#include "paginator.h"
+#include "term_dictionary.h"
+
+struct DocumentTerm {
+    TermId term;
+    uint32_t term_count;
+};
+
+using DocumentTerms = IteratorRange<const DocumentTerm*>;
+
+class ForwardIndex {
+public:
+    void Add(int document_index, const std::vector<DocumentTerm>& terms);
+
+    void Remove(int document_index);
+
+    // Переносит документ i на место new_indices[i]; удалённым документам соответствует -1, порядок сохраняется
+    void Renumber(const std::vector<int>& new_indices, size_t document_count);
+
+    DocumentTerms Get(int document_index) const;
+
+    void Save(IndexFileWriter& writer) const;
+
+    static ForwardIndex Load(IndexFileReader& reader, size_t document_count);
+
+private:
+    std::vector<DocumentTerm> terms_;
+    std::vector<uint64_t> offsets_;
+    std::vector<uint32_t> sizes_;
+    size_t garbage_size_ = 0;
+
+    void Compact();
+};
+
+// Представление частот слов документа поверх прямого индекса и словаря сервера.
+// Слова перечисляются в порядке TermId, а не в алфавитном порядке.
+// Представление действительно до следующего изменения сервера: добавление и удаление
+// документов перераспределяют хранилище прямого индекса и словаря.
+class WordFrequencies {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::pair<std::string_view, double>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        const_iterator(const WordFrequencies* frequencies, const DocumentTerm* position)
+            : frequencies_(frequencies)
+            , position_(position) {
+        }
+
+        value_type operator*() const {
+            return {frequencies_->dictionary_->GetWord(position_->term), position_->term_count * frequencies_->inv_word_count_};
+        }
+
+        const_iterator& operator++() {
+            ++position_;
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return position_ == other.position_;
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return position_ != other.position_;
+        }
+
+    private:
+        const WordFrequencies* frequencies_;
+        const DocumentTerm* position_;
+    };
+
+    WordFrequencies();
+
+    WordFrequencies(const TermDictionary& dictionary, DocumentTerms terms, double inv_word_count);
+
+    const_iterator begin() const;
+
+    const_iterator end() const;
+
+    size_t size() const;
+
+    bool empty() const;
+
+    double at(std::string_view word) const;
+
+    DocumentTerms GetTerms() const;
+
+private:
+    const TermDictionary* dictionary_ = nullptr;
+    DocumentTerms terms_;
+    double inv_word_count_ = 0.0;
+};
+
+bool operator==(const WordFrequencies& lhs, const WordFrequencies& rhs);
+
+bool operator!=(const WordFrequencies& lhs, const WordFrequencies& rhs);
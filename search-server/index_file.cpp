@@ -0,0 +1,236 @@
+#include "index_file.h"
+
+#include <cstdio>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char INDEX_FILE_MAGIC[8] = {'S', 'R', 'C', 'H', 'I', 'D', 'X', '\0'};
+
+struct IndexFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t payload_size;
+    uint64_t checksum;
+};
+
+}
+
+std::shared_ptr<const MappedFile> MappedFile::Open(const std::string& path) {
+    const int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        throw std::runtime_error("Не удалось открыть файл "s + path);
+    }
+    struct stat file_stat;
+    if (fstat(descriptor, &file_stat) != 0) {
+        close(descriptor);
+        throw std::runtime_error("Не удалось открыть файл "s + path);
+    }
+    const size_t size = static_cast<size_t>(file_stat.st_size);
+    void* data = size == 0 ? nullptr : mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Не удалось отобразить файл "s + path);
+    }
+    return std::shared_ptr<const MappedFile>(new MappedFile(static_cast<const char*>(data), size));
+}
+
+MappedFile::MappedFile(const char* data, size_t size)
+    : data_(data)
+    , size_(size) {
+}
+
+MappedFile::~MappedFile() {
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+const char* MappedFile::data() const {
+    return data_;
+}
+
+size_t MappedFile::size() const {
+    return size_;
+}
+
+void Checksum::Update(const char* data, size_t size) {
+    total_size_ += size;
+    while (size > 0 && pending_size_ > 0) {
+        pending_ |= static_cast<uint64_t>(static_cast<unsigned char>(*data++)) << (8 * pending_size_);
+        --size;
+        if (++pending_size_ == sizeof(uint64_t)) {
+            Mix(pending_);
+            pending_ = 0;
+            pending_size_ = 0;
+        }
+    }
+    for (; size >= sizeof(uint64_t); data += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        Mix(word);
+    }
+    for (; size > 0; --size) {
+        pending_ |= static_cast<uint64_t>(static_cast<unsigned char>(*data++)) << (8 * pending_size_++);
+    }
+}
+
+uint64_t Checksum::Get() const {
+    Checksum result = *this;
+    result.Mix(pending_);
+    result.Mix(total_size_);
+    uint64_t hash = result.hash_;
+    hash ^= hash >> 31;
+    hash *= 0x94d049bb133111ebULL;
+    return hash ^ (hash >> 29);
+}
+
+void Checksum::Mix(uint64_t word) {
+    hash_ ^= word;
+    hash_ = (hash_ << 29) | (hash_ >> 35);
+    hash_ *= 0xbf58476d1ce4e5b9ULL;
+}
+
+IndexFileWriter::IndexFileWriter(const std::string& path)
+    : path_(path)
+    , temporary_path_(path + ".tmp"s)
+    , output_(temporary_path_, std::ios::binary | std::ios::trunc) {
+    if (!output_) {
+        throw std::runtime_error("Не удалось открыть файл "s + temporary_path_);
+    }
+    const IndexFileHeader header{};
+    output_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void IndexFileWriter::Write(const char* data, size_t size) {
+    output_.write(data, size);
+    checksum_.Update(data, size);
+    size_ += size;
+}
+
+void IndexFileWriter::WriteString(std::string_view text) {
+    WriteValue<uint64_t>(text.size());
+    Write(text.data(), text.size());
+}
+
+void IndexFileWriter::WriteSection(std::string_view data, uint64_t checksum) {
+    WriteValue<uint64_t>(data.size());
+    WriteValue(checksum);
+    Align();
+    output_.write(data.data(), data.size());
+    size_ += data.size();
+}
+
+void IndexFileWriter::Align() {
+    const char padding[INDEX_FILE_ALIGNMENT] = {};
+    Write(padding, (INDEX_FILE_ALIGNMENT - size_ % INDEX_FILE_ALIGNMENT) % INDEX_FILE_ALIGNMENT);
+}
+
+void IndexFileWriter::Finish() {
+    IndexFileHeader header{};
+    std::memcpy(header.magic, INDEX_FILE_MAGIC, sizeof(header.magic));
+    header.version = INDEX_FORMAT_VERSION;
+    header.payload_size = size_;
+    header.checksum = checksum_.Get();
+    output_.seekp(0);
+    output_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output_.close();
+    if (!output_) {
+        throw std::runtime_error("Не удалось записать индекс"s);
+    }
+    const int descriptor = open(temporary_path_.c_str(), O_RDONLY);
+    const bool is_synced = descriptor >= 0 && fsync(descriptor) == 0;
+    if (descriptor >= 0) {
+        close(descriptor);
+    }
+    if (!is_synced || std::rename(temporary_path_.c_str(), path_.c_str()) != 0) {
+        throw std::runtime_error("Не удалось записать индекс"s);
+    }
+    is_finished_ = true;
+}
+
+IndexFileWriter::~IndexFileWriter() {
+    if (!is_finished_) {
+        output_.close();
+        std::remove(temporary_path_.c_str());
+    }
+}
+
+IndexFileReader::IndexFileReader(const std::string& path)
+    : file_(MappedFile::Open(path))
+    , position_(sizeof(IndexFileHeader))
+    , size_(file_->size()) {
+    IndexFileHeader header;
+    if (size_ < sizeof(header)) {
+        throw std::runtime_error("Некорректный формат индекса"s);
+    }
+    std::memcpy(&header, file_->data(), sizeof(header));
+    if (std::memcmp(header.magic, INDEX_FILE_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Некорректный формат индекса"s);
+    }
+    if (header.version != INDEX_FORMAT_VERSION) {
+        throw std::runtime_error("Неподдерживаемая версия индекса"s);
+    }
+    if (header.payload_size != size_ - sizeof(header)) {
+        throw std::runtime_error("Некорректный формат индекса"s);
+    }
+    expected_checksum_ = header.checksum;
+}
+
+const char* IndexFileReader::Read(size_t size) {
+    const char* data = Skip(size);
+    checksum_.Update(data, size);
+    return data;
+}
+
+const char* IndexFileReader::Skip(size_t size) {
+    if (size > size_ - position_) {
+        throw std::runtime_error("Некорректный формат индекса"s);
+    }
+    const char* data = file_->data() + position_;
+    position_ += size;
+    return data;
+}
+
+std::string_view IndexFileReader::ReadString() {
+    const uint64_t size = ReadValue<uint64_t>();
+    return {Read(size), size};
+}
+
+uint64_t IndexFileReader::ReadCount(size_t item_size) {
+    const uint64_t count = ReadValue<uint64_t>();
+    if (count > (size_ - position_) / item_size) {
+        throw std::runtime_error("Некорректный формат индекса"s);
+    }
+    return count;
+}
+
+std::string_view IndexFileReader::ReadSection(uint64_t& checksum) {
+    const uint64_t size = ReadValue<uint64_t>();
+    checksum = ReadValue<uint64_t>();
+    Align();
+    return {Skip(size), size};
+}
+
+void IndexFileReader::Align() {
+    const size_t offset = position_ - sizeof(IndexFileHeader);
+    Read((INDEX_FILE_ALIGNMENT - offset % INDEX_FILE_ALIGNMENT) % INDEX_FILE_ALIGNMENT);
+}
+
+void IndexFileReader::Finish() const {
+    if (position_ != size_) {
+        throw std::runtime_error("Некорректный формат индекса"s);
+    }
+    if (checksum_.Get() != expected_checksum_) {
+        throw std::runtime_error("Контрольная сумма индекса не совпадает"s);
+    }
+}
+
+std::shared_ptr<const void> IndexFileReader::GetOwner() const {
+    return file_;
+}
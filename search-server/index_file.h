@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+using std::literals::string_literals::operator""s;
+
+const uint32_t INDEX_FORMAT_VERSION = 3;
+const size_t INDEX_FILE_ALIGNMENT = 8;
+
+class MappedFile {
+public:
+    static std::shared_ptr<const MappedFile> Open(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const;
+
+    size_t size() const;
+
+private:
+    MappedFile(const char* data, size_t size);
+
+    const char* data_;
+    size_t size_;
+};
+
+class Checksum {
+public:
+    void Update(const char* data, size_t size);
+
+    uint64_t Get() const;
+
+private:
+    uint64_t hash_ = 0x9e3779b97f4a7c15ULL;
+    uint64_t pending_ = 0;
+    size_t pending_size_ = 0;
+    uint64_t total_size_ = 0;
+
+    void Mix(uint64_t word);
+};
+
+class IndexFileWriter {
+public:
+    explicit IndexFileWriter(const std::string& path);
+
+    ~IndexFileWriter();
+
+    IndexFileWriter(const IndexFileWriter&) = delete;
+    IndexFileWriter& operator=(const IndexFileWriter&) = delete;
+
+    void Write(const char* data, size_t size);
+
+    template <typename T>
+    void WriteValue(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        Write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void WriteArray(const T* data, size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        Align();
+        Write(reinterpret_cast<const char*>(data), count * sizeof(T));
+    }
+
+    void WriteString(std::string_view text);
+
+    // Данные секции не входят в общую контрольную сумму файла, вместо неё записывается своя
+    void WriteSection(std::string_view data, uint64_t checksum);
+
+    void Align();
+
+    void Finish();
+
+private:
+    std::string path_;
+    std::string temporary_path_;
+    std::ofstream output_;
+    Checksum checksum_;
+    uint64_t size_ = 0;
+    bool is_finished_ = false;
+};
+
+class IndexFileReader {
+public:
+    explicit IndexFileReader(const std::string& path);
+
+    const char* Read(size_t size);
+
+    template <typename T>
+    T ReadValue() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, Read(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    const T* ReadArray(size_t count) {
+        Align();
+        if (count > size_ / sizeof(T)) {
+            throw std::runtime_error("Некорректный формат индекса"s);
+        }
+        return reinterpret_cast<const T*>(Read(count * sizeof(T)));
+    }
+
+    std::string_view ReadString();
+
+    // Читает число элементов, каждый из которых занимает в файле не меньше item_size байт
+    uint64_t ReadCount(size_t item_size);
+
+    // Возвращает данные секции без проверки, её контрольная сумма записывается в checksum
+    std::string_view ReadSection(uint64_t& checksum);
+
+    void Align();
+
+    // Сверяет контрольную сумму прочитанных данных вне секций и проверяет, что файл прочитан целиком
+    void Finish() const;
+
+    std::shared_ptr<const void> GetOwner() const;
+
+private:
+    std::shared_ptr<const MappedFile> file_;
+    size_t position_;
+    size_t size_;
+    uint64_t expected_checksum_;
+    Checksum checksum_;
+
+    const char* Skip(size_t size);
+};
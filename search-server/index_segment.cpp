@@ -0,0 +1,314 @@
+#include "index_segment.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include "bit_packing.h"
+
+using std::literals::string_literals::operator""s;
+
+struct IndexSegment::Header {
+    int32_t first_document_index;
+    int32_t last_document_index;
+    uint64_t term_count;
+    uint64_t block_count;
+    uint64_t packed_count;
+    uint64_t tail_count;
+    uint64_t purged_count;
+};
+
+struct IndexSegment::TermEntry {
+    uint64_t block_begin;
+    uint64_t packed_begin;
+    uint64_t tail_begin;
+    uint64_t size;
+    double max_term_freq;
+    uint32_t block_count;
+    uint32_t tail_count;
+};
+
+namespace {
+
+size_t AlignedSize(size_t size) {
+    return (size + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+}
+
+}
+
+IndexSegment::IndexSegment(int first_document_index)
+    : first_document_index_(first_document_index)
+    , last_document_index_(first_document_index) {
+}
+
+void IndexSegment::Add(int document_index, TermId term, uint32_t term_count, double term_freq) {
+    if (postings_.size() <= term) {
+        postings_.resize(term + 1);
+    }
+    postings_[term].Add(document_index, term_count, term_freq);
+    last_document_index_ = std::max(last_document_index_, document_index + 1);
+}
+
+void IndexSegment::Seal(int last_document_index) {
+    std::vector<TermId> terms;
+    std::vector<PostingList> postings;
+    for (TermId term = 0; term < postings_.size(); ++term) {
+        if (!postings_[term].empty()) {
+            terms.push_back(term);
+            postings.push_back(std::move(postings_[term]));
+        }
+    }
+    *this = Pack(first_document_index_, last_document_index, 0, terms, postings);
+}
+
+PostingListView IndexSegment::Find(TermId term) const {
+    if (!sealed_) {
+        return term < postings_.size() ? postings_[term].GetView() : PostingListView();
+    }
+    EnsureValidated();
+    const TermId* it = std::lower_bound(terms_, terms_ + term_count_, term);
+    if (it == terms_ + term_count_ || *it != term) {
+        return PostingListView();
+    }
+    const TermEntry& entry = entries_[it - terms_];
+    return PostingListView(blocks_ + entry.block_begin, entry.block_count, packed_ + entry.packed_begin, tail_ + entry.tail_begin, entry.tail_count, entry.size, entry.max_term_freq);
+}
+
+bool IndexSegment::IsSealed() const {
+    return sealed_;
+}
+
+int IndexSegment::GetFirstDocumentIndex() const {
+    return first_document_index_;
+}
+
+int IndexSegment::GetLastDocumentIndex() const {
+    return last_document_index_;
+}
+
+int IndexSegment::GetPurgedCount() const {
+    return purged_count_;
+}
+
+std::string_view IndexSegment::GetData() const {
+    return data_;
+}
+
+uint64_t IndexSegment::GetChecksum() const {
+    return checksum_;
+}
+
+IndexSegment IndexSegment::Build(int first_document_index, int last_document_index, std::vector<SegmentPosting> postings) {
+    std::stable_sort(postings.begin(), postings.end(), [](const SegmentPosting& lhs, const SegmentPosting& rhs) {
+        return lhs.term < rhs.term;
+    });
+    std::vector<TermId> terms;
+    std::vector<PostingList> term_postings;
+    for (const SegmentPosting& posting : postings) {
+        if (terms.empty() || terms.back() != posting.term) {
+            terms.push_back(posting.term);
+            term_postings.emplace_back();
+        }
+        term_postings.back().Add(posting.document_index, posting.term_count, posting.term_freq);
+    }
+    return Pack(first_document_index, last_document_index, 0, terms, term_postings);
+}
+
+IndexSegment IndexSegment::Merge(const std::vector<std::shared_ptr<const IndexSegment>>& segments, const std::vector<bool>& tombstones, const std::vector<double>& inv_word_counts) {
+    const int first_document_index = segments.front()->GetFirstDocumentIndex();
+    std::vector<int> document_indices(tombstones.size());
+    for (size_t offset = 0; offset < tombstones.size(); ++offset) {
+        document_indices[offset] = tombstones[offset] ? -1 : first_document_index + static_cast<int>(offset);
+    }
+    const int purged_count = std::count(tombstones.begin(), tombstones.end(), true);
+    return Combine(segments, document_indices, inv_word_counts, first_document_index, segments.back()->GetLastDocumentIndex(), purged_count);
+}
+
+IndexSegment IndexSegment::Renumber(const std::vector<std::shared_ptr<const IndexSegment>>& segments, const std::vector<int>& document_indices, const std::vector<double>& inv_word_counts, int first_document_index, int last_document_index) {
+    return Combine(segments, document_indices, inv_word_counts, first_document_index, last_document_index, 0);
+}
+
+IndexSegment IndexSegment::Combine(const std::vector<std::shared_ptr<const IndexSegment>>& segments, const std::vector<int>& document_indices, const std::vector<double>& inv_word_counts, int first_document_index, int last_document_index, int purged_count) {
+    const int first_old_index = segments.front()->GetFirstDocumentIndex();
+    std::map<TermId, PostingList> term_postings;
+    for (const auto& segment : segments) {
+        for (size_t i = 0; i < segment->term_count_; ++i) {
+            PostingList* postings = nullptr;
+            for (const auto [document_index, term_count] : segment->Find(segment->terms_[i])) {
+                const int offset = document_index - first_old_index;
+                if (document_indices[offset] < 0) {
+                    continue;
+                }
+                if (!postings) {
+                    postings = &term_postings[segment->terms_[i]];
+                }
+                postings->Add(document_indices[offset], term_count, term_count * inv_word_counts[offset]);
+            }
+        }
+    }
+    std::vector<TermId> terms;
+    std::vector<PostingList> postings;
+    terms.reserve(term_postings.size());
+    postings.reserve(term_postings.size());
+    for (auto& [term, list] : term_postings) {
+        terms.push_back(term);
+        postings.push_back(std::move(list));
+    }
+    return Pack(first_document_index, last_document_index, purged_count, terms, postings);
+}
+
+IndexSegment IndexSegment::FromData(std::shared_ptr<const void> storage, std::string_view data, uint64_t checksum) {
+    IndexSegment result(0);
+    result.Attach(std::move(storage), data);
+    result.checksum_ = checksum;
+    result.validation_ = std::make_shared<std::once_flag>();
+    return result;
+}
+
+IndexSegment IndexSegment::Pack(int first_document_index, int last_document_index, int purged_count, const std::vector<TermId>& terms, const std::vector<PostingList>& postings) {
+    Header header{first_document_index, last_document_index, terms.size(), 0, 0, 0, static_cast<uint64_t>(purged_count)};
+    std::vector<TermEntry> entries(terms.size());
+    for (size_t i = 0; i < terms.size(); ++i) {
+        const PostingListView view = postings[i].GetView();
+        entries[i] = {header.block_count, header.packed_count, header.tail_count, view.size_, view.max_term_freq_, static_cast<uint32_t>(view.block_count_), static_cast<uint32_t>(view.tail_size_)};
+        header.block_count += view.block_count_;
+        header.packed_count += view.GetPackedWordCount();
+        header.tail_count += view.tail_size_;
+    }
+    const size_t size = sizeof(Header) + AlignedSize(header.term_count * sizeof(TermId)) + header.term_count * sizeof(TermEntry) + header.block_count * sizeof(PostingBlock) + AlignedSize(header.packed_count * sizeof(uint32_t)) + header.tail_count * sizeof(Posting);
+    auto buffer = std::make_shared<std::vector<uint64_t>>(size / sizeof(uint64_t));
+    char* const data = reinterpret_cast<char*>(buffer->data());
+    char* output = data;
+    const auto write = [&output](const void* input, size_t input_size, bool align) {
+        if (input_size > 0) {
+            std::memcpy(output, input, input_size);
+        }
+        output += align ? AlignedSize(input_size) : input_size;
+    };
+    write(&header, sizeof(header), false);
+    write(terms.data(), terms.size() * sizeof(TermId), true);
+    write(entries.data(), entries.size() * sizeof(TermEntry), false);
+    for (const PostingList& list : postings) {
+        const PostingListView view = list.GetView();
+        write(view.blocks_, view.block_count_ * sizeof(PostingBlock), false);
+    }
+    char* const packed_begin = output;
+    for (const PostingList& list : postings) {
+        const PostingListView view = list.GetView();
+        write(view.packed_, view.GetPackedWordCount() * sizeof(uint32_t), false);
+    }
+    output = packed_begin + AlignedSize(header.packed_count * sizeof(uint32_t));
+    for (const PostingList& list : postings) {
+        const PostingListView view = list.GetView();
+        write(view.tail_, view.tail_size_ * sizeof(Posting), false);
+    }
+    IndexSegment result(first_document_index);
+    result.Attach(std::move(buffer), std::string_view(data, size));
+    Checksum checksum;
+    checksum.Update(data, size);
+    result.checksum_ = checksum.Get();
+    return result;
+}
+
+void IndexSegment::Attach(std::shared_ptr<const void> storage, std::string_view data) {
+    if (data.size() < sizeof(Header) || reinterpret_cast<uintptr_t>(data.data()) % sizeof(uint64_t) != 0) {
+        throw std::runtime_error("Некорректный формат индекса"s);
+    }
+    const Header* header = reinterpret_cast<const Header*>(data.data());
+    const size_t max_count = data.size() / sizeof(uint32_t);
+    if (header->term_count > max_count || header->block_count > max_count || header->packed_count > max_count || header->tail_count > max_count
+        || header->first_document_index < 0 || header->last_document_index < header->first_document_index
+        || header->purged_count > static_cast<uint64_t>(header->last_document_index - header->first_document_index)) {
+        throw std::runtime_error("Некорректный формат индекса"s);
+    }
+    const size_t terms_offset = sizeof(Header);
+    const size_t entries_offset = terms_offset + AlignedSize(header->term_count * sizeof(TermId));
+    const size_t blocks_offset = entries_offset + header->term_count * sizeof(TermEntry);
+    const size_t packed_offset = blocks_offset + header->block_count * sizeof(PostingBlock);
+    const size_t tail_offset = packed_offset + AlignedSize(header->packed_count * sizeof(uint32_t));
+    if (tail_offset + header->tail_count * sizeof(Posting) != data.size()) {
+        throw std::runtime_error("Некорректный формат индекса"s);
+    }
+    first_document_index_ = header->first_document_index;
+    last_document_index_ = header->last_document_index;
+    purged_count_ = static_cast<int>(header->purged_count);
+    sealed_ = true;
+    postings_.clear();
+    postings_.shrink_to_fit();
+    storage_ = std::move(storage);
+    data_ = data;
+    term_count_ = header->term_count;
+    terms_ = reinterpret_cast<const TermId*>(data.data() + terms_offset);
+    entries_ = reinterpret_cast<const TermEntry*>(data.data() + entries_offset);
+    blocks_ = reinterpret_cast<const PostingBlock*>(data.data() + blocks_offset);
+    packed_ = reinterpret_cast<const uint32_t*>(data.data() + packed_offset);
+    tail_ = reinterpret_cast<const Posting*>(data.data() + tail_offset);
+}
+
+void IndexSegment::EnsureValidated() const {
+    if (validation_) {
+        std::call_once(*validation_, [this] {
+            Validate();
+        });
+    }
+}
+
+void IndexSegment::Validate() const {
+    Checksum checksum;
+    checksum.Update(data_.data(), data_.size());
+    if (checksum.Get() != checksum_) {
+        throw std::runtime_error("Контрольная сумма индекса не совпадает"s);
+    }
+    const auto check = [](bool condition) {
+        if (!condition) {
+            throw std::runtime_error("Некорректный формат индекса"s);
+        }
+    };
+    const Header* header = reinterpret_cast<const Header*>(data_.data());
+    std::array<uint32_t, POSTING_BLOCK_SIZE> values;
+    for (size_t i = 0; i < term_count_; ++i) {
+        check(i == 0 || terms_[i - 1] < terms_[i]);
+        const TermEntry& entry = entries_[i];
+        check(entry.block_count <= header->block_count && entry.block_begin <= header->block_count - entry.block_count);
+        check(entry.tail_count <= header->tail_count && entry.tail_begin <= header->tail_count - entry.tail_count);
+        check(entry.packed_begin <= header->packed_count);
+        check(std::isfinite(entry.max_term_freq) && entry.max_term_freq >= 0.0);
+        const uint64_t packed_size = header->packed_count - entry.packed_begin;
+        const uint32_t* packed = packed_ + entry.packed_begin;
+
+        int64_t first_document_index = -1;
+        int64_t last_document_index = -1;
+        uint64_t size = entry.tail_count;
+        for (const PostingBlock* block_it = blocks_ + entry.block_begin; block_it != blocks_ + entry.block_begin + entry.block_count; ++block_it) {
+            const PostingBlock& block = *block_it;
+            check(block.size > 0 && block.size <= POSTING_BLOCK_SIZE && block.document_bits <= 32 && block.count_bits <= 32);
+            check(block.base_document_index >= last_document_index && block.base_document_index < block.last_document_index);
+            const size_t document_words = PackedWordCount(block.size, block.document_bits);
+            check(block.offset <= packed_size && document_words + PackedWordCount(block.size, block.count_bits) <= packed_size - block.offset);
+            UnpackBits(packed + block.offset, block.size, block.document_bits, values.data());
+            int64_t document_index = block.base_document_index;
+            for (size_t j = 0; j < block.size; ++j) {
+                document_index += static_cast<int64_t>(values[j]) + 1;
+                if (first_document_index < 0) {
+                    first_document_index = document_index;
+                }
+            }
+            check(document_index == block.last_document_index);
+            last_document_index = document_index;
+            size += block.size;
+        }
+        for (const Posting* posting = tail_ + entry.tail_begin; posting != tail_ + entry.tail_begin + entry.tail_count; ++posting) {
+            check(posting->document_index > last_document_index && posting->term_count > 0);
+            if (first_document_index < 0) {
+                first_document_index = posting->document_index;
+            }
+            last_document_index = posting->document_index;
+        }
+        check(size == entry.size);
+        check(size == 0 || (first_document_index >= first_document_index_ && last_document_index < last_document_index_));
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "posting_list.h"
+#include "term_dictionary.h"
+
+const int SEGMENT_SEAL_SIZE = 1 << 13;
+const size_t SEGMENT_MERGE_FACTOR = 4;
+
+struct SegmentPosting {
+    TermId term;
+    int document_index;
+    uint32_t term_count;
+    double term_freq;
+};
+
+class IndexSegment {
+public:
+    explicit IndexSegment(int first_document_index);
+
+    void Add(int document_index, TermId term, uint32_t term_count, double term_freq);
+
+    void Seal(int last_document_index);
+
+    PostingListView Find(TermId term) const;
+
+    void EnsureValidated() const;
+
+    bool IsSealed() const;
+
+    int GetFirstDocumentIndex() const;
+
+    int GetLastDocumentIndex() const;
+
+    // Число удалённых документов диапазона, исключённых из сегмента при слиянии
+    int GetPurgedCount() const;
+
+    std::string_view GetData() const;
+
+    uint64_t GetChecksum() const;
+
+    static IndexSegment Build(int first_document_index, int last_document_index, std::vector<SegmentPosting> postings);
+
+    static IndexSegment Merge(const std::vector<std::shared_ptr<const IndexSegment>>& segments, const std::vector<bool>& tombstones, const std::vector<double>& inv_word_counts);
+
+    // Сливает сегменты, перенумеровывая документы: document_indices[i] — новый индекс документа
+    // first + i или -1 для удалённого; новые индексы возрастают и заполняют [first_document_index, last_document_index)
+    static IndexSegment Renumber(const std::vector<std::shared_ptr<const IndexSegment>>& segments, const std::vector<int>& document_indices, const std::vector<double>& inv_word_counts, int first_document_index, int last_document_index);
+
+    // Проверяет только заголовок; контрольная сумма и списки проверяются при первом Find
+    static IndexSegment FromData(std::shared_ptr<const void> storage, std::string_view data, uint64_t checksum);
+
+private:
+    struct Header;
+    struct TermEntry;
+
+    int first_document_index_;
+    int last_document_index_;
+    int purged_count_ = 0;
+    bool sealed_ = false;
+    std::vector<PostingList> postings_;
+    std::shared_ptr<const void> storage_;
+    std::string_view data_;
+    const TermId* terms_ = nullptr;
+    const TermEntry* entries_ = nullptr;
+    size_t term_count_ = 0;
+    const PostingBlock* blocks_ = nullptr;
+    const uint32_t* packed_ = nullptr;
+    const Posting* tail_ = nullptr;
+    uint64_t checksum_ = 0;
+    std::shared_ptr<std::once_flag> validation_;
+
+    static IndexSegment Combine(const std::vector<std::shared_ptr<const IndexSegment>>& segments, const std::vector<int>& document_indices, const std::vector<double>& inv_word_counts, int first_document_index, int last_document_index, int purged_count);
+
+    static IndexSegment Pack(int first_document_index, int last_document_index, int purged_count, const std::vector<TermId>& terms, const std::vector<PostingList>& postings);
+
+    void Attach(std::shared_ptr<const void> storage, std::string_view data);
+
+    void Validate() const;
+};
@@ -38,7 +38,7 @@ void PrintDocument(const Document& document) {
          << "rating = "s << document.rating << " }"s << std::endl;
 }
 
-void PrintMatchDocumentResult(int document_id, const std::vector<std::string_view>& words, DocumentStatus status) {
+void PrintMatchDocumentResult(int document_id, IteratorRange<MatchedDocuments::WordIterator> words, DocumentStatus status) {
     std::cout << "{ "s
          << "document_id = "s << document_id << ", "s
          << "status = "s << static_cast<int>(status) << ", "s
@@ -73,9 +73,9 @@ void MatchDocuments(const SearchServer& search_server, const std::string& query)
     LOG_DURATION_STREAM("Operation time"s, std::cout);
     try {
         std::cout << "Матчинг документов по запросу: "s << query << std::endl;
-        for (const int document_id : search_server) {
-            const auto [words, status] = search_server.MatchDocument(query, document_id);
-            PrintMatchDocumentResult(document_id, words, status);
+        const MatchedDocuments matched_documents = search_server.MatchDocuments(query);
+        for (size_t i = 0; i < matched_documents.size(); ++i) {
+            PrintMatchDocumentResult(matched_documents.GetDocumentId(i), matched_documents.GetWords(i), matched_documents.GetStatus(i));
         }
     } catch (const std::exception& e) {
         std::cout << "Ошибка матчинга документов на запрос "s << query << ": "s << e.what() << std::endl;
@@ -0,0 +1,29 @@
+#include "matched_documents.h"
+
+#include <utility>
+
+MatchedDocuments::MatchedDocuments(std::vector<Entry> entries, std::vector<std::string_view> words)
+    : entries_(std::move(entries))
+    , words_(std::move(words)) {
+}
+
+size_t MatchedDocuments::size() const {
+    return entries_.size();
+}
+
+bool MatchedDocuments::empty() const {
+    return entries_.empty();
+}
+
+int MatchedDocuments::GetDocumentId(size_t position) const {
+    return entries_.at(position).document_id;
+}
+
+DocumentStatus MatchedDocuments::GetStatus(size_t position) const {
+    return entries_.at(position).status;
+}
+
+IteratorRange<MatchedDocuments::WordIterator> MatchedDocuments::GetWords(size_t position) const {
+    const Entry& entry = entries_.at(position);
+    return {words_.begin() + entry.first_word, words_.begin() + entry.last_word};
+}
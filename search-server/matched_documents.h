@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "document.h"
+#include "paginator.h"
+
+class MatchedDocuments {
+public:
+    using WordIterator = std::vector<std::string_view>::const_iterator;
+
+    struct Entry {
+        int document_id;
+        DocumentStatus status;
+        size_t first_word;
+        size_t last_word;
+    };
+
+    MatchedDocuments() = default;
+
+    MatchedDocuments(std::vector<Entry> entries, std::vector<std::string_view> words);
+
+    size_t size() const;
+
+    bool empty() const;
+
+    int GetDocumentId(size_t position) const;
+
+    DocumentStatus GetStatus(size_t position) const;
+
+    IteratorRange<WordIterator> GetWords(size_t position) const;
+
+private:
+    std::vector<Entry> entries_;
+    std::vector<std::string_view> words_;
+};
@@ -0,0 +1,238 @@
+#include "near_duplicates.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <string_view>
+
+using std::literals::string_literals::operator""s;
+
+namespace {
+
+const size_t MAX_FULL_BUCKET_SIZE = 32;
+
+uint64_t MixHash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    return hash ^ (hash >> 33);
+}
+
+struct Banding {
+    size_t band_count;
+    size_t row_count;
+};
+
+Banding ChooseBanding(double jaccard_threshold) {
+    Banding banding{MINHASH_SIGNATURE_SIZE, 1};
+    for (size_t row_count = 1; row_count <= MINHASH_SIGNATURE_SIZE; row_count *= 2) {
+        const size_t band_count = MINHASH_SIGNATURE_SIZE / row_count;
+        if (std::pow(1.0 / band_count, 1.0 / row_count) <= jaccard_threshold) {
+            banding = {band_count, row_count};
+        }
+    }
+    return banding;
+}
+
+const std::array<std::pair<uint64_t, uint64_t>, MINHASH_SIGNATURE_SIZE>& GetMinHashFunctions() {
+    static const auto functions = [] {
+        std::array<std::pair<uint64_t, uint64_t>, MINHASH_SIGNATURE_SIZE> result;
+        for (size_t i = 0; i < MINHASH_SIGNATURE_SIZE; ++i) {
+            result[i] = {MixHash(2 * i + 1) | 1, MixHash(2 * i + 2)};
+        }
+        return result;
+    }();
+    return functions;
+}
+
+struct DocumentSketch {
+    std::vector<uint64_t> word_hashes;
+    std::vector<uint64_t> band_keys;
+};
+
+DocumentSketch BuildSketch(const SearchServer& search_server, int document_id, const Banding& banding) {
+    DocumentSketch sketch;
+    for (const auto& [word, _] : search_server.GetWordFrequencies(document_id)) {
+        sketch.word_hashes.push_back(MixHash(std::hash<std::string_view>{}(word)));
+    }
+    std::sort(sketch.word_hashes.begin(), sketch.word_hashes.end());
+    sketch.word_hashes.erase(std::unique(sketch.word_hashes.begin(), sketch.word_hashes.end()), sketch.word_hashes.end());
+    if (sketch.word_hashes.empty()) {
+        return sketch;
+    }
+
+    const auto& functions = GetMinHashFunctions();
+    std::array<uint64_t, MINHASH_SIGNATURE_SIZE> signature;
+    signature.fill(std::numeric_limits<uint64_t>::max());
+    for (const uint64_t word_hash : sketch.word_hashes) {
+        for (size_t i = 0; i < MINHASH_SIGNATURE_SIZE; ++i) {
+            signature[i] = std::min(signature[i], word_hash * functions[i].first + functions[i].second);
+        }
+    }
+    sketch.band_keys.resize(banding.band_count);
+    for (size_t band = 0; band < banding.band_count; ++band) {
+        uint64_t key = MixHash(band + 1);
+        for (size_t row = 0; row < banding.row_count; ++row) {
+            key = MixHash(key ^ signature[band * banding.row_count + row]);
+        }
+        sketch.band_keys[band] = key;
+    }
+    return sketch;
+}
+
+double ComputeJaccard(const std::vector<uint64_t>& lhs, const std::vector<uint64_t>& rhs) {
+    size_t intersection = 0;
+    for (auto lhs_it = lhs.begin(), rhs_it = rhs.begin(); lhs_it != lhs.end() && rhs_it != rhs.end();) {
+        if (*lhs_it < *rhs_it) {
+            ++lhs_it;
+        } else if (*rhs_it < *lhs_it) {
+            ++rhs_it;
+        } else {
+            ++intersection;
+            ++lhs_it;
+            ++rhs_it;
+        }
+    }
+    return static_cast<double>(intersection) / (lhs.size() + rhs.size() - intersection);
+}
+
+size_t FindRoot(std::vector<size_t>& parents, size_t node) {
+    while (parents[node] != node) {
+        parents[node] = parents[parents[node]];
+        node = parents[node];
+    }
+    return node;
+}
+
+template <class ExecutionPolicy>
+std::vector<std::vector<int>> FindNearDuplicatesImpl(ExecutionPolicy&& policy, const SearchServer& search_server, double jaccard_threshold) {
+    if (!(jaccard_threshold > 0.0 && jaccard_threshold <= 1.0)) {
+        throw std::invalid_argument("Некорректный порог схожести"s);
+    }
+    const Banding banding = ChooseBanding(jaccard_threshold);
+    const std::vector<int> document_ids(search_server.begin(), search_server.end());
+    std::vector<DocumentSketch> sketches(document_ids.size());
+    std::transform(policy, document_ids.begin(), document_ids.end(), sketches.begin(), [&](int document_id) {
+        return BuildSketch(search_server, document_id, banding);
+    });
+
+    struct BandEntry {
+        uint64_t key;
+        uint32_t document;
+    };
+    std::vector<BandEntry> entries;
+    entries.reserve(document_ids.size() * banding.band_count);
+    for (uint32_t document = 0; document < sketches.size(); ++document) {
+        for (const uint64_t key : sketches[document].band_keys) {
+            entries.push_back({key, document});
+        }
+    }
+    std::sort(policy, entries.begin(), entries.end(), [](const BandEntry& lhs, const BandEntry& rhs) {
+        return lhs.key < rhs.key || (lhs.key == rhs.key && lhs.document < rhs.document);
+    });
+
+    std::vector<std::pair<uint32_t, uint32_t>> candidates;
+    for (auto first = entries.begin(); first != entries.end();) {
+        const auto last = std::find_if(first, entries.end(), [first](const BandEntry& entry) {
+            return entry.key != first->key;
+        });
+        const size_t bucket_size = last - first;
+        for (auto it = std::next(first); it != last; ++it) {
+            if (bucket_size <= MAX_FULL_BUCKET_SIZE) {
+                for (auto other = first; other != it; ++other) {
+                    candidates.emplace_back(other->document, it->document);
+                }
+            } else {
+                candidates.emplace_back(first->document, it->document);
+                candidates.emplace_back(std::prev(it)->document, it->document);
+            }
+        }
+        first = last;
+    }
+    std::sort(policy, candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<char> is_similar(candidates.size());
+    std::transform(policy, candidates.begin(), candidates.end(), is_similar.begin(), [&](const std::pair<uint32_t, uint32_t>& candidate) {
+        const auto& lhs = sketches[candidate.first].word_hashes;
+        const auto& rhs = sketches[candidate.second].word_hashes;
+        if (std::min(lhs.size(), rhs.size()) < jaccard_threshold * std::max(lhs.size(), rhs.size())) {
+            return char{0};
+        }
+        return static_cast<char>(ComputeJaccard(lhs, rhs) >= jaccard_threshold);
+    });
+
+    std::vector<size_t> parents(document_ids.size());
+    std::iota(parents.begin(), parents.end(), 0);
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (is_similar[i]) {
+            const size_t lhs_root = FindRoot(parents, candidates[i].first);
+            const size_t rhs_root = FindRoot(parents, candidates[i].second);
+            parents[std::max(lhs_root, rhs_root)] = std::min(lhs_root, rhs_root);
+        }
+    }
+    std::vector<std::vector<int>> clusters;
+    std::vector<size_t> root_to_cluster(document_ids.size(), document_ids.size());
+    for (size_t document = 0; document < document_ids.size(); ++document) {
+        const size_t root = FindRoot(parents, document);
+        if (root == document) {
+            continue;
+        }
+        if (root_to_cluster[root] == document_ids.size()) {
+            root_to_cluster[root] = clusters.size();
+            clusters.push_back({document_ids[root]});
+        }
+        clusters[root_to_cluster[root]].push_back(document_ids[document]);
+    }
+    std::sort(clusters.begin(), clusters.end());
+    return clusters;
+}
+
+template <class ExecutionPolicy>
+void RemoveNearDuplicatesImpl(ExecutionPolicy&& policy, SearchServer& search_server, double jaccard_threshold) {
+    std::vector<int> duplicate_numbers;
+    for (const std::vector<int>& cluster : FindNearDuplicatesImpl(policy, search_server, jaccard_threshold)) {
+        const int best_id = *std::max_element(cluster.begin(), cluster.end(), [&search_server](int lhs, int rhs) {
+            return search_server.GetDocumentRating(lhs) < search_server.GetDocumentRating(rhs);
+        });
+        std::copy_if(cluster.begin(), cluster.end(), std::back_inserter(duplicate_numbers), [best_id](int document_id) {
+            return document_id != best_id;
+        });
+    }
+    std::sort(duplicate_numbers.begin(), duplicate_numbers.end());
+    for (const int duplicate_number : duplicate_numbers) {
+        std::cout << "Found near duplicate document id "s << duplicate_number << std::endl;
+        search_server.RemoveDocument(policy, duplicate_number);
+    }
+}
+
+}
+
+std::vector<std::vector<int>> FindNearDuplicates(const SearchServer& search_server, double jaccard_threshold) {
+    return FindNearDuplicatesImpl(std::execution::seq, search_server, jaccard_threshold);
+}
+
+std::vector<std::vector<int>> FindNearDuplicates(std::execution::sequenced_policy policy, const SearchServer& search_server, double jaccard_threshold) {
+    return FindNearDuplicatesImpl(policy, search_server, jaccard_threshold);
+}
+
+std::vector<std::vector<int>> FindNearDuplicates(std::execution::parallel_policy policy, const SearchServer& search_server, double jaccard_threshold) {
+    return FindNearDuplicatesImpl(policy, search_server, jaccard_threshold);
+}
+
+void RemoveNearDuplicates(SearchServer& search_server, double jaccard_threshold) {
+    RemoveNearDuplicatesImpl(std::execution::seq, search_server, jaccard_threshold);
+}
+
+void RemoveNearDuplicates(std::execution::sequenced_policy policy, SearchServer& search_server, double jaccard_threshold) {
+    RemoveNearDuplicatesImpl(policy, search_server, jaccard_threshold);
+}
+
+void RemoveNearDuplicates(std::execution::parallel_policy policy, SearchServer& search_server, double jaccard_threshold) {
+    RemoveNearDuplicatesImpl(policy, search_server, jaccard_threshold);
+}
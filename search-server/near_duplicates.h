@@ -0,0 +1,21 @@
+#pragma once
+
+#include <execution>
+#include <vector>
+
+#include "search_server.h"
+
+const size_t MINHASH_SIGNATURE_SIZE = 128;
+const double NEAR_DUPLICATE_THRESHOLD = 0.8;
+
+std::vector<std::vector<int>> FindNearDuplicates(const SearchServer& search_server, double jaccard_threshold = NEAR_DUPLICATE_THRESHOLD);
+
+std::vector<std::vector<int>> FindNearDuplicates(std::execution::sequenced_policy policy, const SearchServer& search_server, double jaccard_threshold = NEAR_DUPLICATE_THRESHOLD);
+
+std::vector<std::vector<int>> FindNearDuplicates(std::execution::parallel_policy policy, const SearchServer& search_server, double jaccard_threshold = NEAR_DUPLICATE_THRESHOLD);
+
+void RemoveNearDuplicates(SearchServer& search_server, double jaccard_threshold = NEAR_DUPLICATE_THRESHOLD);
+
+void RemoveNearDuplicates(std::execution::sequenced_policy policy, SearchServer& search_server, double jaccard_threshold = NEAR_DUPLICATE_THRESHOLD);
+
+void RemoveNearDuplicates(std::execution::parallel_policy policy, SearchServer& search_server, double jaccard_threshold = NEAR_DUPLICATE_THRESHOLD);
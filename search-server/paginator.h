@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <iterator>
 
 template <typename Iterator>
 class IteratorRange {
@@ -9,7 +10,7 @@ public:
     IteratorRange(Iterator begin, Iterator end)
         : first_(begin)
         , last_(end)
-        , size_(distance(first_, last_)) {
+        , size_(std::distance(first_, last_)) {
     }
 
     Iterator begin() const {
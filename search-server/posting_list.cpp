@@ -0,0 +1,264 @@
+#include "posting_list.h"
+
+#include "bit_packing.h"
+
+void PostingList::Add(int document_index, uint32_t term_count, double term_freq) {
+    if (size_ > 0 && document_index <= GetLastDocumentIndex()) {
+        std::vector<Posting> postings = DecodeAll();
+        auto it = std::lower_bound(postings.begin(), postings.end(), document_index, [](const Posting& posting, int index) {
+            return posting.document_index < index;
+        });
+        if (it != postings.end() && it->document_index == document_index) {
+            it->term_count += term_count;
+        } else {
+            postings.insert(it, {document_index, term_count});
+        }
+        blocks_.clear();
+        packed_.clear();
+        tail_.clear();
+        size_ = 0;
+        for (const Posting posting : postings) {
+            Add(posting.document_index, posting.term_count, 0.0);
+        }
+        max_term_freq_ = std::max(max_term_freq_, term_freq);
+        return;
+    }
+    max_term_freq_ = std::max(max_term_freq_, term_freq);
+    tail_.push_back({document_index, term_count});
+    ++size_;
+    if (tail_.size() == POSTING_BLOCK_SIZE) {
+        AppendBlock(tail_.data(), tail_.size());
+        tail_.clear();
+    }
+}
+
+bool PostingList::Remove(int document_index) {
+    if (!tail_.empty() && tail_.front().document_index <= document_index) {
+        auto it = std::lower_bound(tail_.begin(), tail_.end(), document_index, [](const Posting& posting, int index) {
+            return posting.document_index < index;
+        });
+        if (it == tail_.end() || it->document_index != document_index) {
+            return false;
+        }
+        tail_.erase(it);
+    } else {
+        const PostingListView view = GetView();
+        const size_t block = view.FindBlock(document_index);
+        if (block == blocks_.size()) {
+            return false;
+        }
+        std::vector<Posting> postings(POSTING_BLOCK_SIZE);
+        postings.resize(view.DecodeBlock(block, postings.data()));
+        auto it = std::lower_bound(postings.begin(), postings.end(), document_index, [](const Posting& posting, int index) {
+            return posting.document_index < index;
+        });
+        if (it == postings.end() || it->document_index != document_index) {
+            return false;
+        }
+        postings.erase(it);
+        ReplaceBlock(block, postings);
+    }
+    if (--size_ == 0) {
+        max_term_freq_ = 0.0;
+    }
+    return true;
+}
+
+bool PostingList::Contains(int document_index) const {
+    return GetView().Contains(document_index);
+}
+
+size_t PostingList::size() const {
+    return size_;
+}
+
+bool PostingList::empty() const {
+    return size_ == 0;
+}
+
+double PostingList::GetMaxTermFreq() const {
+    return max_term_freq_;
+}
+
+PostingListView PostingList::GetView() const {
+    return PostingListView(blocks_.data(), blocks_.size(), packed_.data(), tail_.data(), tail_.size(), size_, max_term_freq_);
+}
+
+PostingList::const_iterator PostingList::begin() const {
+    return const_iterator(GetView());
+}
+
+PostingList::const_iterator PostingList::end() const {
+    return const_iterator();
+}
+
+int PostingList::GetLastDocumentIndex() const {
+    return tail_.empty() ? blocks_.back().last_document_index : tail_.back().document_index;
+}
+
+std::vector<uint32_t> PostingList::EncodeBlock(const Posting* postings, size_t count, int base_document_index, PostingBlock& block) const {
+    std::array<uint32_t, POSTING_BLOCK_SIZE> deltas;
+    std::array<uint32_t, POSTING_BLOCK_SIZE> counts;
+    uint32_t max_delta = 0;
+    uint32_t max_count = 0;
+    int previous = base_document_index;
+    for (size_t i = 0; i < count; ++i) {
+        deltas[i] = static_cast<uint32_t>(postings[i].document_index - previous - 1);
+        counts[i] = postings[i].term_count - 1;
+        previous = postings[i].document_index;
+        max_delta = std::max(max_delta, deltas[i]);
+        max_count = std::max(max_count, counts[i]);
+    }
+    block.base_document_index = base_document_index;
+    block.last_document_index = previous;
+    block.size = static_cast<uint16_t>(count);
+    block.document_bits = RequiredBits(max_delta);
+    block.count_bits = RequiredBits(max_count);
+    const size_t document_words = PackedWordCount(count, block.document_bits);
+    std::vector<uint32_t> words(document_words + PackedWordCount(count, block.count_bits));
+    PackBits(deltas.data(), count, block.document_bits, words.data());
+    PackBits(counts.data(), count, block.count_bits, words.data() + document_words);
+    return words;
+}
+
+void PostingList::AppendBlock(const Posting* postings, size_t count) {
+    PostingBlock block;
+    const int base_document_index = blocks_.empty() ? -1 : blocks_.back().last_document_index;
+    const std::vector<uint32_t> words = EncodeBlock(postings, count, base_document_index, block);
+    block.offset = static_cast<uint32_t>(packed_.size());
+    packed_.insert(packed_.end(), words.begin(), words.end());
+    blocks_.push_back(block);
+}
+
+void PostingList::ReplaceBlock(size_t block, const std::vector<Posting>& postings) {
+    PostingBlock& info = blocks_[block];
+    const size_t old_begin = info.offset;
+    const size_t old_end = block + 1 < blocks_.size() ? blocks_[block + 1].offset : packed_.size();
+    std::vector<uint32_t> words;
+    if (!postings.empty()) {
+        words = EncodeBlock(postings.data(), postings.size(), info.base_document_index, info);
+    }
+    packed_.erase(packed_.begin() + old_begin, packed_.begin() + old_end);
+    packed_.insert(packed_.begin() + old_begin, words.begin(), words.end());
+    const std::ptrdiff_t shift = static_cast<std::ptrdiff_t>(words.size()) - static_cast<std::ptrdiff_t>(old_end - old_begin);
+    for (size_t i = block + 1; i < blocks_.size(); ++i) {
+        blocks_[i].offset = static_cast<uint32_t>(blocks_[i].offset + shift);
+    }
+    if (postings.empty()) {
+        blocks_.erase(blocks_.begin() + block);
+    }
+}
+
+std::vector<Posting> PostingList::DecodeAll() const {
+    std::vector<Posting> postings(blocks_.size() * POSTING_BLOCK_SIZE);
+    const PostingListView view = GetView();
+    size_t count = 0;
+    for (size_t block = 0; block < blocks_.size(); ++block) {
+        count += view.DecodeBlock(block, postings.data() + count);
+    }
+    postings.resize(count);
+    postings.insert(postings.end(), tail_.begin(), tail_.end());
+    return postings;
+}
+
+PostingListView::PostingListView(const PostingBlock* blocks, size_t block_count, const uint32_t* packed, const Posting* tail, size_t tail_size, size_t size, double max_term_freq)
+    : blocks_(blocks)
+    , block_count_(block_count)
+    , packed_(packed)
+    , tail_(tail)
+    , tail_size_(tail_size)
+    , size_(size)
+    , max_term_freq_(max_term_freq) {
+}
+
+bool PostingListView::Contains(int document_index) const {
+    PostingCursor cursor(*this);
+    cursor.NextGeq(document_index);
+    return !cursor.IsEnd() && cursor.GetDocumentIndex() == document_index;
+}
+
+size_t PostingListView::size() const {
+    return size_;
+}
+
+bool PostingListView::empty() const {
+    return size_ == 0;
+}
+
+double PostingListView::GetMaxTermFreq() const {
+    return max_term_freq_;
+}
+
+PostingListView::const_iterator PostingListView::begin() const {
+    return const_iterator(*this);
+}
+
+PostingListView::const_iterator PostingListView::end() const {
+    return const_iterator();
+}
+
+size_t PostingListView::FindBlock(int document_index, size_t first_block) const {
+    return std::lower_bound(blocks_ + first_block, blocks_ + block_count_, document_index, [](const PostingBlock& block, int index) {
+        return block.last_document_index < index;
+    }) - blocks_;
+}
+
+size_t PostingListView::DecodeBlock(size_t block, Posting* output) const {
+    const PostingBlock& info = blocks_[block];
+    std::array<uint32_t, POSTING_BLOCK_SIZE> values;
+    const uint32_t* input = packed_ + info.offset;
+    UnpackBits(input, info.size, info.document_bits, values.data());
+    int document_index = info.base_document_index;
+    for (size_t i = 0; i < info.size; ++i) {
+        document_index += static_cast<int>(values[i]) + 1;
+        output[i].document_index = document_index;
+    }
+    UnpackBits(input + PackedWordCount(info.size, info.document_bits), info.size, info.count_bits, values.data());
+    for (size_t i = 0; i < info.size; ++i) {
+        output[i].term_count = values[i] + 1;
+    }
+    return info.size;
+}
+
+size_t PostingListView::GetPackedWordCount() const {
+    if (block_count_ == 0) {
+        return 0;
+    }
+    const PostingBlock& last = blocks_[block_count_ - 1];
+    return last.offset + PackedWordCount(last.size, last.document_bits) + PackedWordCount(last.size, last.count_bits);
+}
+
+void PostingCursor::NextGeq(int document_index) {
+    if (IsEnd() || buffer_[position_].document_index >= document_index) {
+        return;
+    }
+    if (buffer_[count_ - 1].document_index < document_index) {
+        size_t block = block_ + 1;
+        if (block < postings_.block_count_) {
+            block = postings_.FindBlock(document_index, block);
+        }
+        LoadBlock(block);
+        if (IsEnd()) {
+            return;
+        }
+    }
+    position_ = std::lower_bound(buffer_.begin() + position_, buffer_.begin() + count_, document_index, [](const Posting& posting, int index) {
+        return posting.document_index < index;
+    }) - buffer_.begin();
+    if (position_ == count_) {
+        LoadBlock(block_ + 1);
+    }
+}
+
+void PostingCursor::LoadBlock(size_t block) {
+    block_ = block;
+    position_ = 0;
+    if (block < postings_.block_count_) {
+        count_ = postings_.DecodeBlock(block, buffer_.data());
+    } else if (block == postings_.block_count_) {
+        count_ = postings_.tail_size_;
+        std::copy(postings_.tail_, postings_.tail_ + postings_.tail_size_, buffer_.begin());
+    } else {
+        count_ = 0;
+    }
+}
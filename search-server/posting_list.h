@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+const size_t POSTING_BLOCK_SIZE = 128;
+
+struct Posting {
+    int document_index;
+    uint32_t term_count;
+};
+
+struct PostingBlock {
+    int base_document_index;
+    int last_document_index;
+    uint32_t offset;
+    uint16_t size;
+    uint8_t document_bits;
+    uint8_t count_bits;
+};
+
+class PostingIterator;
+
+class PostingListView {
+public:
+    using const_iterator = PostingIterator;
+
+    PostingListView() = default;
+
+    PostingListView(const PostingBlock* blocks, size_t block_count, const uint32_t* packed, const Posting* tail, size_t tail_size, size_t size, double max_term_freq);
+
+    bool Contains(int document_index) const;
+
+    size_t size() const;
+
+    bool empty() const;
+
+    double GetMaxTermFreq() const;
+
+    const_iterator begin() const;
+
+    const_iterator end() const;
+
+private:
+    friend class PostingCursor;
+    friend class PostingList;
+    friend class IndexSegment;
+
+    const PostingBlock* blocks_ = nullptr;
+    size_t block_count_ = 0;
+    const uint32_t* packed_ = nullptr;
+    const Posting* tail_ = nullptr;
+    size_t tail_size_ = 0;
+    size_t size_ = 0;
+    double max_term_freq_ = 0.0;
+
+    size_t FindBlock(int document_index, size_t first_block = 0) const;
+
+    size_t DecodeBlock(size_t block, Posting* output) const;
+
+    size_t GetPackedWordCount() const;
+};
+
+class PostingList {
+public:
+    using const_iterator = PostingIterator;
+
+    void Add(int document_index, uint32_t term_count, double term_freq);
+
+    bool Remove(int document_index);
+
+    bool Contains(int document_index) const;
+
+    size_t size() const;
+
+    bool empty() const;
+
+    double GetMaxTermFreq() const;
+
+    PostingListView GetView() const;
+
+    const_iterator begin() const;
+
+    const_iterator end() const;
+
+private:
+    std::vector<PostingBlock> blocks_;
+    std::vector<uint32_t> packed_;
+    std::vector<Posting> tail_;
+    size_t size_ = 0;
+    double max_term_freq_ = 0.0;
+
+    int GetLastDocumentIndex() const;
+
+    std::vector<uint32_t> EncodeBlock(const Posting* postings, size_t count, int base_document_index, PostingBlock& block) const;
+
+    void AppendBlock(const Posting* postings, size_t count);
+
+    void ReplaceBlock(size_t block, const std::vector<Posting>& postings);
+
+    std::vector<Posting> DecodeAll() const;
+};
+
+class PostingCursor {
+public:
+    PostingCursor() = default;
+
+    explicit PostingCursor(const PostingListView& postings)
+        : postings_(postings) {
+        LoadBlock(0);
+    }
+
+    explicit PostingCursor(const PostingList& postings)
+        : PostingCursor(postings.GetView()) {
+    }
+
+    bool IsEnd() const {
+        return position_ == count_;
+    }
+
+    int GetDocumentIndex() const {
+        return buffer_[position_].document_index;
+    }
+
+    uint32_t GetTermCount() const {
+        return buffer_[position_].term_count;
+    }
+
+    const Posting& GetPosting() const {
+        return buffer_[position_];
+    }
+
+    void Next() {
+        if (++position_ == count_) {
+            LoadBlock(block_ + 1);
+        }
+    }
+
+    void NextGeq(int document_index);
+
+private:
+    PostingListView postings_;
+    size_t block_ = 0;
+    size_t position_ = 0;
+    size_t count_ = 0;
+    std::array<Posting, POSTING_BLOCK_SIZE> buffer_;
+
+    void LoadBlock(size_t block);
+};
+
+class PostingIterator {
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Posting;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Posting*;
+    using reference = const Posting&;
+
+    PostingIterator() = default;
+
+    explicit PostingIterator(const PostingListView& postings)
+        : cursor_(postings) {
+    }
+
+    const Posting& operator*() const {
+        return cursor_.GetPosting();
+    }
+
+    const Posting* operator->() const {
+        return &cursor_.GetPosting();
+    }
+
+    PostingIterator& operator++() {
+        cursor_.Next();
+        return *this;
+    }
+
+    bool operator==(const PostingIterator& other) const {
+        return cursor_.IsEnd() && other.cursor_.IsEnd();
+    }
+
+    bool operator!=(const PostingIterator& other) const {
+        return !(*this == other);
+    }
+
+private:
+    PostingCursor cursor_;
+};
@@ -1,15 +1,193 @@
 #include "process_queries.h"
 
+#include <atomic>
+#include <deque>
+#include <map>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+
+namespace {
+
+const size_t BATCH_CHUNK_SIZE = 64;
+
+// Исполнитель создаётся один раз на процесс и делится между вызывающими потоками
+template <typename Func>
+auto RunOnSharedExecutor(Func func) {
+    static BatchExecutor executor;
+    return func(executor);
+}
+
+template <typename Func>
+void ForEachIndex(BatchExecutor& executor, size_t count, Func func) {
+    for (size_t first = 0; first < count; first += BATCH_CHUNK_SIZE) {
+        const size_t last = std::min(count, first + BATCH_CHUNK_SIZE);
+        executor.Submit([first, last, &func] {
+            for (size_t i = first; i < last; ++i) {
+                func(i);
+            }
+        });
+    }
+    executor.Wait();
+}
+
+struct QueryLess {
+    bool operator()(const SearchServer::Query* lhs, const SearchServer::Query* rhs) const {
+        return std::tie(lhs->plus_words, lhs->minus_words) < std::tie(rhs->plus_words, rhs->minus_words);
+    }
+};
+
+struct SplitQuery {
+    std::vector<TopDocuments> range_tops;
+    std::atomic<size_t> remaining_ranges;
+};
+
+struct DistinctQueries {
+    std::vector<SearchServer::Query> parsed_queries;
+    std::vector<const SearchServer::Query*> queries;
+    std::vector<size_t> first_queries;
+    std::vector<size_t> query_to_distinct;
+};
+
+DistinctQueries GroupDistinctQueries(BatchExecutor& executor, const SearchServer& search_server, const std::vector<std::string>& queries) {
+    std::unordered_map<std::string_view, size_t> text_to_unique;
+    std::vector<std::string_view> unique_texts;
+    std::vector<size_t> unique_first_queries;
+    std::vector<size_t> query_to_unique(queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const auto [it, inserted] = text_to_unique.emplace(queries[i], unique_texts.size());
+        if (inserted) {
+            unique_texts.push_back(queries[i]);
+            unique_first_queries.push_back(i);
+        }
+        query_to_unique[i] = it->second;
+    }
+
+    DistinctQueries distinct;
+    distinct.parsed_queries.resize(unique_texts.size());
+    ForEachIndex(executor, unique_texts.size(), [&](size_t i) {
+        distinct.parsed_queries[i] = search_server.ParseQuery(unique_texts[i]);
+    });
+
+    std::map<const SearchServer::Query*, size_t, QueryLess> query_to_distinct;
+    std::vector<size_t> unique_to_distinct(unique_texts.size());
+    for (size_t i = 0; i < distinct.parsed_queries.size(); ++i) {
+        const auto [it, inserted] = query_to_distinct.emplace(&distinct.parsed_queries[i], distinct.queries.size());
+        if (inserted) {
+            distinct.queries.push_back(&distinct.parsed_queries[i]);
+            distinct.first_queries.push_back(unique_first_queries[i]);
+        }
+        unique_to_distinct[i] = it->second;
+    }
+    for (size_t& query : query_to_unique) {
+        query = unique_to_distinct[query];
+    }
+    distinct.query_to_distinct = std::move(query_to_unique);
+    return distinct;
+}
+
+template <typename ResultConsumer>
+void FindDistinctTopDocuments(BatchExecutor& executor, const SearchServer& search_server, const DistinctQueries& distinct, ResultConsumer consumer) {
+    const DocumentStatusFilter is_actual{DocumentStatus::ACTUAL};
+    const auto ranges = search_server.SplitDocumentRanges();
+    std::deque<SplitQuery> split_queries;
+    for (size_t i = 0; i < distinct.queries.size(); ++i) {
+        const SearchServer::Query& query = *distinct.queries[i];
+        if (ranges.size() < 2 || search_server.GetQueryCost(query) < MIN_SPLIT_QUERY_COST) {
+            executor.Submit([&, i] {
+                TopDocuments top_documents = search_server.CollectTopDocuments(query, is_actual);
+                consumer(i, top_documents);
+            });
+            continue;
+        }
+        auto& split_query = split_queries.emplace_back();
+        split_query.range_tops.resize(ranges.size(), TopDocuments(MAX_RESULT_DOCUMENT_COUNT));
+        split_query.remaining_ranges = ranges.size();
+        for (size_t range = 0; range < ranges.size(); ++range) {
+            executor.Submit([&, i, range, &split_query = split_query] {
+                split_query.range_tops[range] = search_server.FindTopDocumentsInRange(query, is_actual, ranges[range]);
+                if (--split_query.remaining_ranges == 0) {
+                    for (size_t other = 1; other < ranges.size(); ++other) {
+                        split_query.range_tops.front().Merge(split_query.range_tops[other]);
+                    }
+                    consumer(i, split_query.range_tops.front());
+                }
+            });
+        }
+    }
+    executor.Wait();
+}
+
+}
+
+QueryResultArena::QueryResultArena(std::vector<Document> documents, std::vector<size_t> offsets)
+    : documents_(std::move(documents))
+    , offsets_(std::move(offsets)) {
+}
+
+QueryResultArena::Iterator QueryResultArena::begin() const {
+    return documents_.begin();
+}
+
+QueryResultArena::Iterator QueryResultArena::end() const {
+    return documents_.end();
+}
+
+size_t QueryResultArena::size() const {
+    return documents_.size();
+}
+
+size_t QueryResultArena::GetQueryCount() const {
+    return offsets_.size() - 1;
+}
+
+IteratorRange<QueryResultArena::Iterator> QueryResultArena::GetQueryResults(size_t query) const {
+    return {documents_.begin() + offsets_[query], documents_.begin() + offsets_[query + 1]};
+}
+
 std::vector<std::vector<Document>> ProcessQueries(const SearchServer& search_server, const std::vector<std::string>& queries) {
+    return RunOnSharedExecutor([&](BatchExecutor& executor) {
+        return ProcessQueries(executor, search_server, queries);
+    });
+}
+
+std::vector<std::vector<Document>> ProcessQueries(BatchExecutor& executor, const SearchServer& search_server, const std::vector<std::string>& queries) {
+    const DistinctQueries distinct = GroupDistinctQueries(executor, search_server, queries);
     std::vector<std::vector<Document>> result(queries.size());
-    transform(std::execution::par, queries.begin(), queries.end(), result.begin(), [&search_server] (const std::string& s) {return search_server.FindTopDocuments(s); });
+    FindDistinctTopDocuments(executor, search_server, distinct, [&](size_t i, TopDocuments& top_documents) {
+        result[distinct.first_queries[i]] = top_documents.Release();
+    });
+    ForEachIndex(executor, queries.size(), [&](size_t i) {
+        const size_t first_query = distinct.first_queries[distinct.query_to_distinct[i]];
+        if (first_query != i) {
+            result[i] = result[first_query];
+        }
+    });
     return result;
 }
 
-std::vector<Document> ProcessQueriesJoined(const SearchServer& search_server, const std::vector<std::string>& queries) {
-    std::vector<Document> result;
-    for (const auto& a : ProcessQueries(search_server, queries)) {
-        result.insert(result.end(), a.begin(), a.end());
+QueryResultArena ProcessQueriesJoined(const SearchServer& search_server, const std::vector<std::string>& queries) {
+    return RunOnSharedExecutor([&](BatchExecutor& executor) {
+        return ProcessQueriesJoined(executor, search_server, queries);
+    });
+}
+
+QueryResultArena ProcessQueriesJoined(BatchExecutor& executor, const SearchServer& search_server, const std::vector<std::string>& queries) {
+    const DistinctQueries distinct = GroupDistinctQueries(executor, search_server, queries);
+    std::vector<Document> slots(distinct.queries.size() * MAX_RESULT_DOCUMENT_COUNT);
+    std::vector<size_t> slot_sizes(distinct.queries.size());
+    FindDistinctTopDocuments(executor, search_server, distinct, [&](size_t i, TopDocuments& top_documents) {
+        slot_sizes[i] = top_documents.ReleaseTo(slots.data() + i * MAX_RESULT_DOCUMENT_COUNT);
+    });
+
+    std::vector<size_t> offsets(queries.size() + 1, 0);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        offsets[i + 1] = offsets[i] + slot_sizes[distinct.query_to_distinct[i]];
     }
-    return result;
-}
\ No newline at end of file
+    std::vector<Document> documents(offsets.back());
+    ForEachIndex(executor, queries.size(), [&](size_t i) {
+        const auto slot = slots.begin() + distinct.query_to_distinct[i] * MAX_RESULT_DOCUMENT_COUNT;
+        std::copy(slot, slot + (offsets[i + 1] - offsets[i]), documents.begin() + offsets[i]);
+    });
+    return {std::move(documents), std::move(offsets)};
+}
@@ -7,7 +7,36 @@
 
 #include "document.h"
 #include "search_server.h"
+#include "batch_executor.h"
+#include "paginator.h"
+
+const size_t MIN_SPLIT_QUERY_COST = 1 << 14;
 
 std::vector<std::vector<Document>> ProcessQueries(const SearchServer& search_server, const std::vector<std::string>& queries);
 
-std::vector<Document> ProcessQueriesJoined(const SearchServer& search_server, const std::vector<std::string>& queries);
\ No newline at end of file
+std::vector<std::vector<Document>> ProcessQueries(BatchExecutor& executor, const SearchServer& search_server, const std::vector<std::string>& queries);
+
+class QueryResultArena {
+public:
+    using Iterator = std::vector<Document>::const_iterator;
+
+    QueryResultArena(std::vector<Document> documents, std::vector<size_t> offsets);
+
+    Iterator begin() const;
+
+    Iterator end() const;
+
+    size_t size() const;
+
+    size_t GetQueryCount() const;
+
+    IteratorRange<Iterator> GetQueryResults(size_t query) const;
+
+private:
+    std::vector<Document> documents_;
+    std::vector<size_t> offsets_;
+};
+
+QueryResultArena ProcessQueriesJoined(const SearchServer& search_server, const std::vector<std::string>& queries);
+
+QueryResultArena ProcessQueriesJoined(BatchExecutor& executor, const SearchServer& search_server, const std::vector<std::string>& queries);
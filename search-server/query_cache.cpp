@@ -0,0 +1,85 @@
+#include "query_cache.h"
+
+#include <tuple>
+
+QueryCache::QueryCache(const SearchServer& search_server, size_t capacity, size_t shard_count)
+    : search_server_(search_server)
+    , shards_(std::max<size_t>(shard_count, 1)) {
+    shard_capacity_ = (capacity + shards_.size() - 1) / shards_.size();
+}
+
+std::vector<Document> QueryCache::FindTopDocuments(const std::string_view raw_query, DocumentStatus status, size_t top_count) {
+    return FindOrCompute({search_server_.ParseQuery(raw_query), false, static_cast<uint64_t>(status), top_count}, [&](const SearchServer::Query& query) {
+        return search_server_.FindTopDocuments(query, status, top_count);
+    });
+}
+
+size_t QueryCache::GetHitCount() const {
+    return hits_;
+}
+
+size_t QueryCache::GetMissCount() const {
+    return misses_;
+}
+
+size_t QueryCache::size() const {
+    size_t result = 0;
+    for (const Shard& shard : shards_) {
+        std::lock_guard guard(shard.mutex);
+        result += shard.entries.size();
+    }
+    return result;
+}
+
+void QueryCache::Clear() {
+    for (Shard& shard : shards_) {
+        std::lock_guard guard(shard.mutex);
+        shard.index.clear();
+        shard.entries.clear();
+    }
+    hits_ = 0;
+    misses_ = 0;
+}
+
+size_t QueryCache::KeyHash::operator()(const Key* key) const {
+    uint64_t hash = key->filter_id * 2 + key->is_predicate;
+    const auto combine = [&hash](uint64_t value) {
+        hash = (hash ^ value) * 0x100000001b3ULL;
+    };
+    combine(key->top_count);
+    for (const TermId term : key->query.plus_words) {
+        combine(term);
+    }
+    combine(key->query.minus_words.size());
+    for (const TermId term : key->query.minus_words) {
+        combine(term);
+    }
+    return hash ^ (hash >> 29);
+}
+
+bool QueryCache::KeyEqual::operator()(const Key* lhs, const Key* rhs) const {
+    return std::tie(lhs->is_predicate, lhs->filter_id, lhs->top_count, lhs->query.plus_words, lhs->query.minus_words)
+        == std::tie(rhs->is_predicate, rhs->filter_id, rhs->top_count, rhs->query.plus_words, rhs->query.minus_words);
+}
+
+void QueryCache::Insert(Shard& shard, Key key, uint64_t epoch, const std::vector<Document>& documents) {
+    if (shard_capacity_ == 0) {
+        return;
+    }
+    std::lock_guard guard(shard.mutex);
+    if (const auto it = shard.index.find(&key); it != shard.index.end()) {
+        if (it->second->epoch > epoch) {
+            return;
+        }
+        it->second->epoch = epoch;
+        it->second->documents = documents;
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        return;
+    }
+    shard.entries.push_front({std::move(key), epoch, documents});
+    shard.index.emplace(&shard.entries.front().key, shard.entries.begin());
+    if (shard.entries.size() > shard_capacity_) {
+        shard.index.erase(&shard.entries.back().key);
+        shard.entries.pop_back();
+    }
+}
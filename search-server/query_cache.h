@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "document.h"
+#include "search_server.h"
+#include "cache_line.h"
+
+const size_t DEFAULT_QUERY_CACHE_SHARD_COUNT = 16;
+
+class QueryCache {
+public:
+    QueryCache(const SearchServer& search_server, size_t capacity, size_t shard_count = DEFAULT_QUERY_CACHE_SHARD_COUNT);
+
+    std::vector<Document> FindTopDocuments(const std::string_view raw_query, DocumentStatus status = DocumentStatus::ACTUAL, size_t top_count = MAX_RESULT_DOCUMENT_COUNT);
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(const std::string_view raw_query, uint64_t predicate_id, DocumentPredicate document_predicate, size_t top_count = MAX_RESULT_DOCUMENT_COUNT);
+
+    size_t GetHitCount() const;
+
+    size_t GetMissCount() const;
+
+    size_t size() const;
+
+    void Clear();
+
+private:
+    struct Key {
+        SearchServer::Query query;
+        bool is_predicate;
+        uint64_t filter_id;
+        size_t top_count;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key* key) const;
+    };
+
+    struct KeyEqual {
+        bool operator()(const Key* lhs, const Key* rhs) const;
+    };
+
+    struct Entry {
+        Key key;
+        uint64_t epoch;
+        std::vector<Document> documents;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> entries;
+        std::unordered_map<const Key*, std::list<Entry>::iterator, KeyHash, KeyEqual> index;
+    };
+
+    const SearchServer& search_server_;
+    size_t shard_capacity_;
+    std::vector<Shard> shards_;
+    std::atomic<size_t> hits_{0};
+    std::atomic<size_t> misses_{0};
+
+    template <typename Search>
+    std::vector<Document> FindOrCompute(Key key, Search search);
+
+    void Insert(Shard& shard, Key key, uint64_t epoch, const std::vector<Document>& documents);
+};
+
+template <typename DocumentPredicate>
+std::vector<Document> QueryCache::FindTopDocuments(const std::string_view raw_query, uint64_t predicate_id, DocumentPredicate document_predicate, size_t top_count) {
+    return FindOrCompute({search_server_.ParseQuery(raw_query), true, predicate_id, top_count}, [&](const SearchServer::Query& query) {
+        return search_server_.FindTopDocuments(query, document_predicate, top_count);
+    });
+}
+
+template <typename Search>
+std::vector<Document> QueryCache::FindOrCompute(Key key, Search search) {
+    const uint64_t epoch = search_server_.GetEpoch();
+    Shard& shard = shards_[(KeyHash{}(&key) >> 32) % shards_.size()];
+    {
+        std::lock_guard guard(shard.mutex);
+        const auto it = shard.index.find(&key);
+        if (it != shard.index.end() && it->second->epoch == epoch) {
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+            ++hits_;
+            return it->second->documents;
+        }
+    }
+    ++misses_;
+    std::vector<Document> documents = search(key.query);
+    Insert(shard, std::move(key), epoch, documents);
+    return documents;
+}
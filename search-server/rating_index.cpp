@@ -0,0 +1,41 @@
+#include "rating_index.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+const size_t MIN_UNSORTED_COUNT = 256;
+
+}
+
+void RatingIndex::Add(int rating, int document_index) {
+    entries_.emplace_back(rating, document_index);
+    if (entries_.size() - sorted_count_ > MIN_UNSORTED_COUNT + sorted_count_ / 16) {
+        MergeUnsorted();
+    }
+}
+
+size_t RatingIndex::CountInRange(int min_rating, int max_rating) const {
+    if (max_rating < min_rating) {
+        return 0;
+    }
+    const auto [first, last] = FindSortedRange(min_rating, max_rating);
+    return last - first + std::count_if(entries_.begin() + sorted_count_, entries_.end(), [min_rating, max_rating](const std::pair<int, int>& entry) {
+        return entry.first >= min_rating && entry.first <= max_rating;
+    });
+}
+
+std::pair<size_t, size_t> RatingIndex::FindSortedRange(int min_rating, int max_rating) const {
+    const auto sorted_end = entries_.begin() + sorted_count_;
+    const auto first = std::lower_bound(entries_.begin(), sorted_end, std::pair{min_rating, std::numeric_limits<int>::min()});
+    const auto last = std::upper_bound(first, sorted_end, std::pair{max_rating, std::numeric_limits<int>::max()});
+    return {first - entries_.begin(), last - entries_.begin()};
+}
+
+void RatingIndex::MergeUnsorted() {
+    const auto sorted_end = entries_.begin() + sorted_count_;
+    std::sort(sorted_end, entries_.end());
+    std::inplace_merge(entries_.begin(), sorted_end, entries_.end());
+    sorted_count_ = entries_.size();
+}
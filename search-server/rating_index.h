@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+class RatingIndex {
+public:
+    void Add(int rating, int document_index);
+
+    // Записи удалённых документов остаются в индексе и отбрасываются при сжатии
+    template <typename DocumentPredicate>
+    void Remove(DocumentPredicate is_removed);
+
+    size_t CountInRange(int min_rating, int max_rating) const;
+
+    template <typename Func>
+    void ForEachInRange(int min_rating, int max_rating, Func func) const;
+
+private:
+    std::vector<std::pair<int, int>> entries_;
+    size_t sorted_count_ = 0;
+    size_t garbage_count_ = 0;
+
+    std::pair<size_t, size_t> FindSortedRange(int min_rating, int max_rating) const;
+
+    void MergeUnsorted();
+};
+
+template <typename DocumentPredicate>
+void RatingIndex::Remove(DocumentPredicate is_removed) {
+    if (++garbage_count_ * 2 <= entries_.size()) {
+        return;
+    }
+    MergeUnsorted();
+    auto last = entries_.begin();
+    for (const auto& entry : entries_) {
+        if (!is_removed(entry.second)) {
+            *last++ = entry;
+        }
+    }
+    entries_.erase(last, entries_.end());
+    sorted_count_ = entries_.size();
+    garbage_count_ = 0;
+}
+
+template <typename Func>
+void RatingIndex::ForEachInRange(int min_rating, int max_rating, Func func) const {
+    if (max_rating < min_rating) {
+        return;
+    }
+    const auto [first, last] = FindSortedRange(min_rating, max_rating);
+    for (size_t i = first; i < last; ++i) {
+        func(entries_[i].second);
+    }
+    for (size_t i = sorted_count_; i < entries_.size(); ++i) {
+        if (entries_[i].first >= min_rating && entries_[i].first <= max_rating) {
+            func(entries_[i].second);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#include "relevance_accumulator.h"
+
+RelevanceAccumulator& RelevanceAccumulator::ForCurrentThread(size_t document_bound) {
+    thread_local RelevanceAccumulator accumulator;
+    accumulator.Reset(document_bound);
+    return accumulator;
+}
+
+void RelevanceAccumulator::Reset(size_t document_bound) {
+    Clear();
+    dense_ = document_bound <= MAX_DENSE_ACCUMULATOR_SIZE;
+    if (dense_ && states_.size() < document_bound) {
+        relevances_.resize(document_bound);
+        states_.resize(document_bound, State::EMPTY);
+    }
+}
+
+void RelevanceAccumulator::Exclude(int document_index) {
+    if (!dense_) {
+        sparse_[document_index].excluded = true;
+        return;
+    }
+    if (states_[document_index] == State::EMPTY) {
+        touched_.push_back(document_index);
+    }
+    states_[document_index] = State::EXCLUDED;
+}
+
+bool RelevanceAccumulator::IsExcluded(int document_index) const {
+    if (!dense_) {
+        const auto it = sparse_.find(document_index);
+        return it != sparse_.end() && it->second.excluded;
+    }
+    return states_[document_index] == State::EXCLUDED;
+}
+
+void RelevanceAccumulator::Clear() {
+    for (const int document_index : touched_) {
+        states_[document_index] = State::EMPTY;
+    }
+    touched_.clear();
+    sparse_.clear();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+const size_t MAX_DENSE_ACCUMULATOR_SIZE = 1 << 22;
+
+class RelevanceAccumulator {
+public:
+    static RelevanceAccumulator& ForCurrentThread(size_t document_bound);
+
+    void Reset(size_t document_bound);
+
+    void Add(int document_index, double relevance) {
+        if (!dense_) {
+            auto& entry = sparse_[document_index];
+            if (!entry.excluded) {
+                entry.relevance += relevance;
+            }
+            return;
+        }
+        switch (states_[document_index]) {
+        case State::EMPTY:
+            states_[document_index] = State::SCORED;
+            relevances_[document_index] = relevance;
+            touched_.push_back(document_index);
+            break;
+        case State::SCORED:
+            relevances_[document_index] += relevance;
+            break;
+        case State::EXCLUDED:
+            break;
+        }
+    }
+
+    void Exclude(int document_index);
+
+    bool IsExcluded(int document_index) const;
+
+    template <typename Func>
+    void ForEach(Func func) const {
+        if (!dense_) {
+            for (const auto& [document_index, entry] : sparse_) {
+                if (!entry.excluded) {
+                    func(document_index, entry.relevance);
+                }
+            }
+            return;
+        }
+        for (const int document_index : touched_) {
+            if (states_[document_index] == State::SCORED) {
+                func(document_index, relevances_[document_index]);
+            }
+        }
+    }
+
+private:
+    enum class State : uint8_t {
+        EMPTY,
+        SCORED,
+        EXCLUDED,
+    };
+
+    struct SparseEntry {
+        double relevance = 0.0;
+        bool excluded = false;
+    };
+
+    bool dense_ = true;
+    std::vector<double> relevances_;
+    std::vector<State> states_;
+    std::vector<int> touched_;
+    std::unordered_map<int, SparseEntry> sparse_;
+
+    void Clear();
+};
@@ -1,23 +1,68 @@
 #include "remove_duplicates.h"
 
-void RemoveDuplicates(SearchServer& search_server) {
-    std::set<int> duplicate_numbers;
-    std::set<std::set<std::string>> set_without_duplicates;
-    
-    for (const int document_id : search_server) {
-        std::set<std::string> check_set;
-        const auto& check_document = search_server.GetWordFrequencies(document_id);
-        for (const auto word : check_document) {
-            check_set.emplace(word.first);
-        }
-        if (set_without_duplicates.count(check_set) == 0) {
-            set_without_duplicates.emplace(check_set);
-        } else {
-            duplicate_numbers.emplace(document_id);
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+
+bool HasSameWords(const SearchServer& search_server, int lhs_id, int rhs_id) {
+    const DocumentTerms lhs = search_server.GetWordFrequencies(lhs_id).GetTerms();
+    const DocumentTerms rhs = search_server.GetWordFrequencies(rhs_id).GetTerms();
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](const DocumentTerm& lhs_term, const DocumentTerm& rhs_term) {
+        return lhs_term.term == rhs_term.term;
+    });
+}
+
+std::optional<DocumentSignature> FindSignature(const SearchServer& search_server, int document_id) {
+    try {
+        return search_server.GetDocumentSignature(document_id);
+    } catch (const std::out_of_range&) {
+        return std::nullopt;
+    }
+}
+
+template <class ExecutionPolicy>
+std::vector<int> FindDuplicates(ExecutionPolicy&& policy, const SearchServer& search_server) {
+    struct SignedDocument {
+        DocumentSignature signature;
+        int id;
+    };
+    std::vector<SignedDocument> documents(search_server.GetDocumentCount());
+    std::transform(policy, search_server.begin(), search_server.end(), documents.begin(), [&search_server](int document_id) {
+        return SignedDocument{search_server.GetDocumentSignature(document_id), document_id};
+    });
+    std::sort(policy, documents.begin(), documents.end(), [](const SignedDocument& lhs, const SignedDocument& rhs) {
+        return std::tie(lhs.signature.high, lhs.signature.low, lhs.id) < std::tie(rhs.signature.high, rhs.signature.low, rhs.id);
+    });
+
+    std::vector<int> duplicates;
+    std::vector<int> originals;
+    for (auto first = documents.begin(); first != documents.end();) {
+        const auto last = std::find_if(first, documents.end(), [first](const SignedDocument& document) {
+            return !(document.signature == first->signature);
+        });
+        originals.assign(1, first->id);
+        for (auto it = std::next(first); it != last; ++it) {
+            const bool is_duplicate = std::any_of(originals.begin(), originals.end(), [&](int original_id) {
+                return HasSameWords(search_server, original_id, it->id);
+            });
+            if (is_duplicate) {
+                duplicates.push_back(it->id);
+            } else {
+                originals.push_back(it->id);
+            }
         }
+        first = last;
     }
-    
-    for (const int duplicate_number : duplicate_numbers) {
+    std::sort(duplicates.begin(), duplicates.end());
+    return duplicates;
+}
+
+}
+
+void RemoveDuplicates(SearchServer& search_server) {
+    for (const int duplicate_number : FindDuplicates(std::execution::seq, search_server)) {
         std::cout << "Found duplicate document id "s << duplicate_number << std::endl;
         search_server.RemoveDocument(duplicate_number);
     }
@@ -28,24 +73,69 @@ void RemoveDuplicates(std::execution::sequenced_policy policy, SearchServer& sea
 }
 
 void RemoveDuplicates(std::execution::parallel_policy policy, SearchServer& search_server) {
-    std::set<int> duplicate_numbers;
-    std::set<std::set<std::string>> set_without_duplicates;
-    
-    for (const int document_id : search_server) {
-        std::set<std::string> check_set;
-        const auto& check_document = search_server.GetWordFrequencies(document_id);
-        for (const auto word : check_document) {
-            check_set.emplace(word.first);
+    for (const int duplicate_number : FindDuplicates(policy, search_server)) {
+        std::cout << "Found duplicate document id "s << duplicate_number << std::endl;
+        search_server.RemoveDocument(policy, duplicate_number);
+    }
+}
+
+DuplicateDetector::DuplicateDetector(SearchServer& search_server)
+    : search_server_(search_server) {
+    for (const int document_id : search_server_) {
+        Add(document_id);
+    }
+}
+
+std::optional<int> DuplicateDetector::AddDocument(int document_id, const std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+    search_server_.AddDocument(document_id, document, status, ratings);
+    return Add(document_id);
+}
+
+std::optional<int> DuplicateDetector::Add(int document_id) {
+    return Add(document_id, search_server_.GetDocumentSignature(document_id));
+}
+
+void DuplicateDetector::RemoveDocument(int document_id) {
+    Forget(document_id);
+    search_server_.RemoveDocument(document_id);
+}
+
+// Все добавленные документы, включая оставленные дубликаты, хранятся в корзине своей сигнатуры.
+// Документы, удалённые или заменённые в сервере в обход детектора, вычищаются при обходе корзины.
+std::optional<int> DuplicateDetector::Add(int document_id, const DocumentSignature& signature) {
+    Forget(document_id);
+    auto& documents = signature_to_documents_[signature];
+    documents.erase(std::remove_if(documents.begin(), documents.end(), [&](int other_id) {
+        const std::optional<DocumentSignature> other_signature = FindSignature(search_server_, other_id);
+        const bool is_stale = !other_signature || !(*other_signature == signature);
+        if (is_stale) {
+            document_to_signature_.erase(other_id);
         }
-        if (set_without_duplicates.count(check_set) == 0) {
-            set_without_duplicates.emplace(check_set);
-        } else {
-            duplicate_numbers.emplace(document_id);
+        return is_stale;
+    }), documents.end());
+    std::optional<int> original_id;
+    for (const int other_id : documents) {
+        if (HasSameWords(search_server_, other_id, document_id)) {
+            original_id = other_id;
+            break;
         }
     }
-    
-    for (const int duplicate_number : duplicate_numbers) {
-        std::cout << "Found duplicate document id "s << duplicate_number << std::endl;
-        search_server.RemoveDocument(policy, duplicate_number);
+    documents.push_back(document_id);
+    document_to_signature_.emplace(document_id, signature);
+    return original_id;
+}
+
+void DuplicateDetector::Forget(int document_id) {
+    const auto it = document_to_signature_.find(document_id);
+    if (it == document_to_signature_.end()) {
+        return;
+    }
+    if (const auto bucket = signature_to_documents_.find(it->second); bucket != signature_to_documents_.end()) {
+        auto& documents = bucket->second;
+        documents.erase(std::remove(documents.begin(), documents.end(), document_id), documents.end());
+        if (documents.empty()) {
+            signature_to_documents_.erase(bucket);
+        }
     }
-}
\ No newline at end of file
+    document_to_signature_.erase(it);
+}
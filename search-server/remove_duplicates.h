@@ -4,6 +4,9 @@
 #include <string>
 #include <set>
 #include <execution>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 #include "search_server.h"
 
@@ -12,4 +15,24 @@ void RemoveDuplicates(SearchServer& search_server);
 
 void RemoveDuplicates(std::execution::sequenced_policy, SearchServer& search_server);
 
-void RemoveDuplicates(std::execution::parallel_policy policy, SearchServer& search_server);
\ No newline at end of file
+void RemoveDuplicates(std::execution::parallel_policy policy, SearchServer& search_server);
+
+class DuplicateDetector {
+public:
+    explicit DuplicateDetector(SearchServer& search_server);
+
+    std::optional<int> AddDocument(int document_id, const std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+
+    std::optional<int> Add(int document_id);
+
+    void RemoveDocument(int document_id);
+
+private:
+    SearchServer& search_server_;
+    std::unordered_map<DocumentSignature, std::vector<int>, DocumentSignatureHasher> signature_to_documents_;
+    std::unordered_map<int, DocumentSignature> document_to_signature_;
+
+    std::optional<int> Add(int document_id, const DocumentSignature& signature);
+
+    void Forget(int document_id);
+};
@@ -10,28 +10,210 @@ void SearchServer::AddDocument (int document_id, const std::string_view document
     if (document_id < 0) {
         throw std::invalid_argument("ID не может быть отрицательным"s);
     }
-    if (documents_.count(document_id)) {
+    if (document_to_index_.count(document_id)) {
         throw std::invalid_argument("документ с таким ID уже есть"s);
     }
-    if (!IsValidWord(document)) {
+    thread_local std::vector<std::string_view> words;
+    if (!SplitIntoWordsNoStop(document, words)) {
         throw std::invalid_argument("Некорректный ввод"s);
     }
-    const std::vector<std::string_view> words = SplitIntoWordsNoStop(document);
+    CollectSegmentMerge(false);
     const double inv_word_count = 1.0 / words.size();
+    std::map<TermId, uint32_t> term_counts;
     for (const std::string_view& word : words) {
-        auto it = all_words_.emplace(std::string(word));
-        std::string_view word_view{*it.first};
-        word_to_document_freqs_[word_view][document_id] += inv_word_count;
-        document_to_word_freqs_[document_id][word_view] += inv_word_count;
+        ++term_counts[dictionary_.Intern(word)];
     }
-    documents_.emplace(document_id, DocumentData{ComputeAverageRating(ratings), status});
+    statistics_.Reserve(dictionary_.GetIdBound());
+    const int document_index = static_cast<int>(documents_.size());
+    std::vector<DocumentTerm> document_terms;
+    document_terms.reserve(term_counts.size());
+    for (const auto [term, term_count] : term_counts) {
+        document_terms.push_back({term, term_count});
+        mutable_segment_.Add(document_index, term, term_count, term_count * inv_word_count);
+        statistics_.AddTerm(term);
+    }
+    forward_index_.Add(document_index, document_terms);
+    documents_.push_back({document_id, ComputeAverageRating(ratings), status, inv_word_count});
+    status_documents_[static_cast<size_t>(status)].Set(document_index);
+    rating_index_.Add(documents_.back().rating, document_index);
+    document_to_index_.emplace(document_id, document_index);
     document_ids_.emplace(document_id);
+    statistics_.SetDocumentCount(GetDocumentCount());
+    ++epoch_;
+    if (document_index + 1 - mutable_segment_.GetFirstDocumentIndex() >= SEGMENT_SEAL_SIZE) {
+        SealMutableSegment(document_index + 1);
+        ScheduleSegmentMerge();
+    }
 }
 
-std::vector<Document> SearchServer::FindTopDocuments(const std::string_view raw_query, DocumentStatus status) const {
-        return FindTopDocuments(raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
-            return document_status == status;
+void SearchServer::AddDocuments(const std::vector<DocumentInput>& documents) {
+    AddDocumentsImpl(std::execution::seq, documents);
+}
+
+void SearchServer::AddDocuments(std::execution::sequenced_policy policy, const std::vector<DocumentInput>& documents) {
+    AddDocumentsImpl(policy, documents);
+}
+
+void SearchServer::AddDocuments(std::execution::parallel_policy policy, const std::vector<DocumentInput>& documents) {
+    AddDocumentsImpl(policy, documents);
+}
+
+void SearchServer::AddDocuments(std::execution::parallel_policy policy, const std::vector<DocumentInput>& documents, std::vector<TokenizedDocument> tokenized_documents) {
+    AddTokenizedDocuments(policy, documents, std::move(tokenized_documents));
+}
+
+SearchServer::TokenizedDocument SearchServer::TokenizeDocument(const std::string_view document) const {
+    thread_local std::vector<std::string_view> words;
+    TokenizedDocument tokenized;
+    tokenized.is_valid = SplitIntoWordsNoStop(document, words);
+    tokenized.inv_word_count = 1.0 / words.size();
+    std::sort(words.begin(), words.end());
+    for (const std::string_view word : words) {
+        if (!tokenized.word_counts.empty() && tokenized.word_counts.back().first == word) {
+            ++tokenized.word_counts.back().second;
+        } else {
+            tokenized.word_counts.emplace_back(word, 1);
+        }
+    }
+    return tokenized;
+}
+
+template <class ExecutionPolicy>
+void SearchServer::AddDocumentsImpl(ExecutionPolicy&& policy, const std::vector<DocumentInput>& documents) {
+    std::vector<TokenizedDocument> tokenized_documents(documents.size());
+    std::transform(policy, documents.begin(), documents.end(), tokenized_documents.begin(), [this](const DocumentInput& document) {
+        return TokenizeDocument(document.text);
+    });
+    AddTokenizedDocuments(policy, documents, std::move(tokenized_documents));
+}
+
+template <class ExecutionPolicy>
+void SearchServer::AddTokenizedDocuments(ExecutionPolicy&& policy, const std::vector<DocumentInput>& documents, std::vector<TokenizedDocument> tokenized_documents) {
+    struct ParsedDocument : TokenizedDocument {
+        std::vector<TermId> terms;
+    };
+    if (tokenized_documents.size() != documents.size()) {
+        throw std::invalid_argument("Некорректный ввод"s);
+    }
+    const size_t document_count = documents.size();
+    std::vector<ParsedDocument> parsed_documents(document_count);
+    std::vector<size_t> document_numbers(document_count);
+    std::iota(document_numbers.begin(), document_numbers.end(), 0);
+    std::for_each(policy, document_numbers.begin(), document_numbers.end(), [&](size_t i) {
+        ParsedDocument& parsed = parsed_documents[i];
+        static_cast<TokenizedDocument&>(parsed) = std::move(tokenized_documents[i]);
+        parsed.terms.resize(parsed.word_counts.size());
+        std::transform(parsed.word_counts.begin(), parsed.word_counts.end(), parsed.terms.begin(), [this](const auto& word_count) {
+            return dictionary_.Find(word_count.first);
+        });
+    });
+
+    std::set<int> batch_ids;
+    for (size_t i = 0; i < document_count; ++i) {
+        if (documents[i].id < 0) {
+            throw std::invalid_argument("ID не может быть отрицательным"s);
+        }
+        if (document_to_index_.count(documents[i].id) || !batch_ids.insert(documents[i].id).second) {
+            throw std::invalid_argument("документ с таким ID уже есть"s);
+        }
+        if (!parsed_documents[i].is_valid) {
+            throw std::invalid_argument("Некорректный ввод"s);
+        }
+    }
+    if (document_count == 0) {
+        return;
+    }
+
+    CollectSegmentMerge(false);
+    for (ParsedDocument& parsed : parsed_documents) {
+        for (size_t j = 0; j < parsed.terms.size(); ++j) {
+            if (parsed.terms[j] == TermDictionary::NO_TERM) {
+                parsed.terms[j] = dictionary_.Intern(parsed.word_counts[j].first);
+            }
+        }
+    }
+    statistics_.Reserve(dictionary_.GetIdBound());
+
+    std::vector<std::vector<DocumentTerm>> document_terms(document_count);
+    std::for_each(policy, document_numbers.begin(), document_numbers.end(), [&](size_t i) {
+        const ParsedDocument& parsed = parsed_documents[i];
+        document_terms[i].resize(parsed.terms.size());
+        for (size_t j = 0; j < parsed.terms.size(); ++j) {
+            document_terms[i][j] = {parsed.terms[j], parsed.word_counts[j].second};
+        }
+        std::sort(document_terms[i].begin(), document_terms[i].end(), [](const DocumentTerm& lhs, const DocumentTerm& rhs) {
+            return lhs.term < rhs.term;
         });
+    });
+
+    const int first_index = static_cast<int>(documents_.size());
+    documents_.reserve(documents_.size() + document_count);
+    for (size_t i = 0; i < document_count; ++i) {
+        const DocumentInput& document = documents[i];
+        for (const TermId term : parsed_documents[i].terms) {
+            statistics_.AddTerm(term);
+        }
+        documents_.push_back({document.id, ComputeAverageRating(document.ratings), document.status, parsed_documents[i].inv_word_count});
+        status_documents_[static_cast<size_t>(document.status)].Set(first_index + static_cast<int>(i));
+        rating_index_.Add(documents_.back().rating, first_index + static_cast<int>(i));
+        document_to_index_.emplace(document.id, first_index + static_cast<int>(i));
+        forward_index_.Add(first_index + static_cast<int>(i), document_terms[i]);
+        document_ids_.emplace_hint(document_ids_.end(), document.id);
+    }
+    statistics_.SetDocumentCount(GetDocumentCount());
+    ++epoch_;
+
+    const auto add_to_mutable_segment = [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            const ParsedDocument& parsed = parsed_documents[i];
+            for (size_t j = 0; j < parsed.terms.size(); ++j) {
+                const uint32_t term_count = parsed.word_counts[j].second;
+                mutable_segment_.Add(first_index + static_cast<int>(i), parsed.terms[j], term_count, term_count * parsed.inv_word_count);
+            }
+        }
+    };
+    const size_t fill_count = std::min<size_t>(document_count, SEGMENT_SEAL_SIZE - (first_index - mutable_segment_.GetFirstDocumentIndex()));
+    add_to_mutable_segment(0, fill_count);
+    if (first_index + static_cast<int>(fill_count) - mutable_segment_.GetFirstDocumentIndex() < SEGMENT_SEAL_SIZE) {
+        return;
+    }
+    SealMutableSegment(first_index + static_cast<int>(fill_count));
+
+    std::vector<size_t> chunk_starts;
+    for (size_t first = fill_count; first + SEGMENT_SEAL_SIZE <= document_count; first += SEGMENT_SEAL_SIZE) {
+        chunk_starts.push_back(first);
+    }
+    std::vector<std::shared_ptr<const IndexSegment>> chunk_segments(chunk_starts.size());
+    std::vector<size_t> chunk_numbers(chunk_starts.size());
+    std::iota(chunk_numbers.begin(), chunk_numbers.end(), 0);
+    std::for_each(policy, chunk_numbers.begin(), chunk_numbers.end(), [&](size_t chunk) {
+        std::vector<SegmentPosting> postings;
+        for (size_t i = chunk_starts[chunk]; i < chunk_starts[chunk] + SEGMENT_SEAL_SIZE; ++i) {
+            const ParsedDocument& parsed = parsed_documents[i];
+            for (size_t j = 0; j < parsed.terms.size(); ++j) {
+                const uint32_t term_count = parsed.word_counts[j].second;
+                postings.push_back({parsed.terms[j], first_index + static_cast<int>(i), term_count, term_count * parsed.inv_word_count});
+            }
+        }
+        const int chunk_first_index = first_index + static_cast<int>(chunk_starts[chunk]);
+        chunk_segments[chunk] = std::make_shared<const IndexSegment>(IndexSegment::Build(chunk_first_index, chunk_first_index + SEGMENT_SEAL_SIZE, std::move(postings)));
+    });
+    for (auto& segment : chunk_segments) {
+        sealed_segments_.push_back({std::move(segment), 0});
+    }
+
+    const size_t tail_first = fill_count + chunk_starts.size() * SEGMENT_SEAL_SIZE;
+    mutable_segment_ = IndexSegment(first_index + static_cast<int>(tail_first));
+    add_to_mutable_segment(tail_first, document_count);
+    ScheduleSegmentMerge();
+}
+
+std::vector<Document> SearchServer::FindTopDocuments(const std::string_view raw_query, DocumentStatus status, size_t top_count) const {
+        return FindTopDocuments(raw_query, DocumentStatusFilter{status}, top_count);
+}
+
+std::vector<Document> SearchServer::FindTopDocuments(const Query& query, DocumentStatus status, size_t top_count) const {
+        return FindTopDocuments(query, DocumentStatusFilter{status}, top_count);
 }
 
 std::vector<Document> SearchServer::FindTopDocuments(const std::string_view raw_query) const {
@@ -39,18 +221,12 @@ std::vector<Document> SearchServer::FindTopDocuments(const std::string_view raw_
 }
 
 void SearchServer::RemoveDocument(int document_id) {
-    if (documents_.count(document_id)) {
-        for (const auto& [word, frequency] : document_to_word_freqs_.at(document_id)) {
-            if (word_to_document_freqs_.at(word).size() > 1) {
-                word_to_document_freqs_.at(word).erase(document_id);
-            } else {
-                word_to_document_freqs_.erase(word);
-                all_words_.erase(std::string(word));
-            }
+    if (const auto it = document_to_index_.find(document_id); it != document_to_index_.end()) {
+        for (const auto [term, _] : forward_index_.Get(it->second)) {
+            statistics_.RemoveTerm(term);
+            ReleaseTermIfUnused(term);
         }
-        document_to_word_freqs_.erase(document_id);
-        documents_.erase(document_id);
-        document_ids_.erase(document_id);
+        MarkDocumentRemoved(it);
     }
 }
 
@@ -59,93 +235,427 @@ void SearchServer::RemoveDocument(std::execution::sequenced_policy policy, int d
 }
 
 void SearchServer::RemoveDocument(std::execution::parallel_policy policy, int document_id) {
-    if (documents_.count(document_id)) {
-        std::vector<std::string_view> document_words(document_to_word_freqs_.at(document_id).size());
-        std::transform(document_to_word_freqs_.at(document_id).begin(), document_to_word_freqs_.at(document_id).end(), document_words.begin(), [](auto& word) { return word.first; } );
-        std::for_each(policy, document_words.begin(), document_words.end(), [this, document_id] (auto data) {
-            if (word_to_document_freqs_.at(data).size() > 1) {
-                word_to_document_freqs_.at(data).erase(document_id);
-            } else {
-                word_to_document_freqs_.erase(data);
-                all_words_.erase(std::string(data));
-            }
+    if (const auto it = document_to_index_.find(document_id); it != document_to_index_.end()) {
+        const DocumentTerms terms = forward_index_.Get(it->second);
+        std::vector<TermId> document_terms(terms.size());
+        std::transform(terms.begin(), terms.end(), document_terms.begin(), [](const DocumentTerm& document_term) { return document_term.term; } );
+        std::for_each(policy, document_terms.begin(), document_terms.end(), [this] (TermId term) {
+            statistics_.RemoveTerm(term);
         } );
-        document_to_word_freqs_.erase(document_id);
-        documents_.erase(document_id);
+        for (const TermId term : document_terms) {
+            ReleaseTermIfUnused(term);
+        }
+        MarkDocumentRemoved(it);
+    }
+}
+
+void SearchServer::RemoveDocuments(const std::vector<int>& document_ids) {
+    RemoveDocumentsImpl(std::execution::seq, document_ids);
+}
+
+void SearchServer::RemoveDocuments(std::execution::sequenced_policy policy, const std::vector<int>& document_ids) {
+    RemoveDocumentsImpl(policy, document_ids);
+}
+
+void SearchServer::RemoveDocuments(std::execution::parallel_policy policy, const std::vector<int>& document_ids) {
+    RemoveDocumentsImpl(policy, document_ids);
+}
+
+template <class ExecutionPolicy>
+void SearchServer::RemoveDocumentsImpl(ExecutionPolicy&& policy, const std::vector<int>& document_ids) {
+    std::vector<int> removed_ids;
+    removed_ids.reserve(document_ids.size());
+    std::copy_if(document_ids.begin(), document_ids.end(), std::back_inserter(removed_ids), [this](int document_id) {
+        return document_to_index_.count(document_id) > 0;
+    });
+    std::sort(policy, removed_ids.begin(), removed_ids.end());
+    removed_ids.erase(std::unique(removed_ids.begin(), removed_ids.end()), removed_ids.end());
+    if (removed_ids.empty()) {
+        return;
+    }
+    CollectSegmentMerge(false);
+
+    std::vector<size_t> term_offsets(removed_ids.size() + 1);
+    std::vector<int> document_indexes(removed_ids.size());
+    for (size_t i = 0; i < removed_ids.size(); ++i) {
+        document_indexes[i] = document_to_index_.at(removed_ids[i]);
+        term_offsets[i + 1] = term_offsets[i] + forward_index_.Get(document_indexes[i]).size();
+    }
+    std::vector<TermId> removed_terms(term_offsets.back());
+    std::vector<size_t> document_numbers(removed_ids.size());
+    std::iota(document_numbers.begin(), document_numbers.end(), 0);
+    std::for_each(policy, document_numbers.begin(), document_numbers.end(), [&](size_t i) {
+        const DocumentTerms terms = forward_index_.Get(document_indexes[i]);
+        std::transform(terms.begin(), terms.end(), removed_terms.begin() + term_offsets[i], [](const DocumentTerm& document_term) {
+            return document_term.term;
+        });
+        documents_[document_indexes[i]].is_removed = true;
+    });
+    std::sort(policy, removed_terms.begin(), removed_terms.end());
+
+    for (auto first = removed_terms.begin(); first != removed_terms.end();) {
+        const auto last = std::upper_bound(first, removed_terms.end(), *first);
+        statistics_.RemoveTerm(*first, static_cast<uint32_t>(last - first));
+        ReleaseTermIfUnused(*first);
+        first = last;
+    }
+
+    std::sort(document_indexes.begin(), document_indexes.end());
+    for (const int document_index : document_indexes) {
+        forward_index_.Remove(document_index);
+        status_documents_[static_cast<size_t>(documents_[document_index].status)].Reset(document_index);
+        rating_index_.Remove([this](int removed_index) {
+            return documents_[removed_index].is_removed;
+        });
+    }
+    auto slot = sealed_segments_.begin();
+    for (const int document_index : document_indexes) {
+        if (document_index >= mutable_segment_.GetFirstDocumentIndex()) {
+            break;
+        }
+        while (slot->segment->GetLastDocumentIndex() <= document_index) {
+            ++slot;
+        }
+        ++slot->removed_count;
+    }
+    for (const int document_id : removed_ids) {
+        document_to_index_.erase(document_id);
         document_ids_.erase(document_id);
     }
+    statistics_.SetDocumentCount(GetDocumentCount());
+    ++epoch_;
+    CompactDocumentIndices();
+    CompactSegments(policy);
+    ScheduleSegmentMerge();
+}
+
+void SearchServer::MergeSegments() {
+    while (segment_merge_) {
+        CollectSegmentMerge(true);
+    }
+    if (static_cast<int>(documents_.size()) > mutable_segment_.GetFirstDocumentIndex()) {
+        SealMutableSegment(static_cast<int>(documents_.size()));
+    }
+    if (!sealed_segments_.empty()) {
+        StartSegmentMerge(0, sealed_segments_.size(), std::launch::deferred);
+        CollectSegmentMerge(true);
+    }
+}
+
+size_t SearchServer::GetSegmentCount() const {
+    return sealed_segments_.size() + (static_cast<int>(documents_.size()) > mutable_segment_.GetFirstDocumentIndex() ? 1 : 0);
+}
+
+namespace {
+
+struct StoredDocument {
+    int32_t id;
+    int32_t rating;
+    int32_t status;
+    uint32_t is_removed;
+    double inv_word_count;
+};
+
+}
+
+void SearchServer::Save(const std::string& path) const {
+    IndexFileWriter writer(path);
+    writer.WriteValue<uint64_t>(stop_words_.size());
+    for (const std::string& word : stop_words_) {
+        writer.WriteString(word);
+    }
+    dictionary_.Save(writer);
+    statistics_.Save(writer);
+
+    std::vector<StoredDocument> documents;
+    documents.reserve(documents_.size());
+    for (const DocumentData& document : documents_) {
+        documents.push_back({document.id, document.rating, static_cast<int32_t>(document.status), document.is_removed, document.inv_word_count});
+    }
+    writer.WriteValue<uint64_t>(documents.size());
+    writer.WriteArray(documents.data(), documents.size());
+
+    forward_index_.Save(writer);
+
+    std::vector<SegmentSlot> segments = sealed_segments_;
+    if (static_cast<int>(documents_.size()) > mutable_segment_.GetFirstDocumentIndex()) {
+        IndexSegment segment = mutable_segment_;
+        segment.Seal(static_cast<int>(documents_.size()));
+        segments.push_back({std::make_shared<const IndexSegment>(std::move(segment)), 0});
+        for (int document_index = segments.back().segment->GetFirstDocumentIndex(); document_index < static_cast<int>(documents_.size()); ++document_index) {
+            segments.back().removed_count += documents_[document_index].is_removed;
+        }
+    }
+    writer.WriteValue<uint64_t>(segments.size());
+    for (const SegmentSlot& slot : segments) {
+        writer.WriteValue<int32_t>(slot.removed_count);
+        writer.WriteSection(slot.segment->GetData(), slot.segment->GetChecksum());
+    }
+    writer.WriteValue(epoch_);
+    writer.Finish();
+}
+
+SearchServer SearchServer::Load(const std::string& path) {
+    IndexFileReader reader(path);
+    std::vector<std::string_view> stop_words(reader.ReadCount(sizeof(uint64_t)));
+    for (std::string_view& word : stop_words) {
+        word = reader.ReadString();
+    }
+    SearchServer server(stop_words);
+    server.dictionary_ = TermDictionary::Load(reader);
+    const size_t term_bound = server.dictionary_.GetIdBound();
+    server.statistics_ = CollectionStatistics::Load(reader, term_bound);
+
+    const uint64_t document_count = reader.ReadValue<uint64_t>();
+    const StoredDocument* documents = reader.ReadArray<StoredDocument>(document_count);
+    server.forward_index_ = ForwardIndex::Load(reader, document_count);
+    server.documents_.reserve(document_count);
+    for (uint64_t document_index = 0; document_index < document_count; ++document_index) {
+        const StoredDocument& document = documents[document_index];
+        if (document.id < 0 || document.status < 0 || document.status > static_cast<int32_t>(DocumentStatus::REMOVED)) {
+            throw std::runtime_error("Некорректный формат индекса"s);
+        }
+        server.documents_.push_back({document.id, document.rating, static_cast<DocumentStatus>(document.status), document.inv_word_count, document.is_removed != 0});
+        if (document.is_removed) {
+            continue;
+        }
+        if (!server.document_to_index_.emplace(document.id, static_cast<int>(document_index)).second) {
+            throw std::runtime_error("Некорректный формат индекса"s);
+        }
+        server.status_documents_[static_cast<size_t>(document.status)].Set(static_cast<int>(document_index));
+        server.rating_index_.Add(document.rating, static_cast<int>(document_index));
+        // Термины документа должны идти строго по возрастанию
+        const DocumentTerms terms = server.forward_index_.Get(static_cast<int>(document_index));
+        for (auto it = terms.begin(); it != terms.end(); ++it) {
+            if (it->term >= term_bound || (it != terms.begin() && std::prev(it)->term >= it->term)) {
+                throw std::runtime_error("Некорректный формат индекса"s);
+            }
+        }
+        server.document_ids_.emplace_hint(server.document_ids_.end(), document.id);
+    }
+
+    int next_document_index = 0;
+    server.sealed_segments_.resize(reader.ReadCount(sizeof(int32_t) + 2 * sizeof(uint64_t)));
+    for (SegmentSlot& slot : server.sealed_segments_) {
+        slot.removed_count = reader.ReadValue<int32_t>();
+        uint64_t checksum;
+        const std::string_view data = reader.ReadSection(checksum);
+        slot.segment = std::make_shared<const IndexSegment>(IndexSegment::FromData(reader.GetOwner(), data, checksum));
+        const int first_index = slot.segment->GetFirstDocumentIndex();
+        const int last_index = slot.segment->GetLastDocumentIndex();
+        if (first_index != next_document_index || last_index > static_cast<int>(document_count)) {
+            throw std::runtime_error("Некорректный формат индекса"s);
+        }
+        const int removed_count = std::count_if(server.documents_.begin() + first_index, server.documents_.begin() + last_index, [](const DocumentData& document) {
+            return document.is_removed;
+        });
+        if (slot.removed_count + slot.segment->GetPurgedCount() != removed_count) {
+            throw std::runtime_error("Некорректный формат индекса"s);
+        }
+        next_document_index = last_index;
+    }
+    if (next_document_index != static_cast<int>(document_count)) {
+        throw std::runtime_error("Некорректный формат индекса"s);
+    }
+    server.mutable_segment_ = IndexSegment(next_document_index);
+    server.RecycleReleasedTerms();
+    server.statistics_.SetDocumentCount(server.GetDocumentCount());
+    server.epoch_ = reader.ReadValue<uint64_t>();
+    reader.Finish();
+    return server;
 }
 
 int SearchServer::GetDocumentCount() const {
-    return documents_.size();
+    return document_to_index_.size();
 }
 
-const std::map<std::string_view, double>& SearchServer::GetWordFrequencies(int document_id) const {
-    static const std::map<std::string_view, double> frequencis;
-    if (document_to_word_freqs_.count(document_id)) {
-        return document_to_word_freqs_.at(document_id);
+int SearchServer::GetDocumentRating(int document_id) const {
+    return GetDocumentData(document_id).rating;
+}
+
+uint64_t SearchServer::GetEpoch() const {
+    return epoch_;
+}
+
+WordFrequencies SearchServer::GetWordFrequencies(int document_id) const {
+    const auto it = document_to_index_.find(document_id);
+    if (it == document_to_index_.end()) {
+        return {};
+    }
+    return {dictionary_, forward_index_.Get(it->second), documents_[it->second].inv_word_count};
+}
+
+DocumentSignature SearchServer::GetDocumentSignature(int document_id) const {
+    const auto it = document_to_index_.find(document_id);
+    if (it == document_to_index_.end()) {
+        throw std::out_of_range("Нет такого документа"s);
+    }
+    const DocumentTerms terms = forward_index_.Get(it->second);
+    uint64_t low = 0x9e3779b97f4a7c15ULL ^ terms.size();
+    uint64_t high = 0xc2b2ae3d27d4eb4fULL + terms.size();
+    for (const auto [term, _] : terms) {
+        low = (low ^ term) * 0xff51afd7ed558ccdULL;
+        low ^= low >> 32;
+        high = (high + term + 1) * 0xc4ceb9fe1a85ec53ULL;
+        high ^= high >> 29;
     }
-    return frequencis;
+    const auto finalize = [](uint64_t hash) {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        return hash ^ (hash >> 33);
+    };
+    return {finalize(low), finalize(high)};
+}
+
+TermStatistics SearchServer::GetTermStatistics(const std::string_view word) const {
+    const TermId term = dictionary_.Find(word);
+    return term == TermDictionary::NO_TERM ? TermStatistics{} : statistics_.GetTermStatistics(term);
+}
+
+const CollectionStatistics& SearchServer::GetCollectionStatistics() const {
+    return statistics_;
 }
 
 using matching_result = std::tuple<std::vector<std::string_view>, DocumentStatus>;
 
 matching_result SearchServer::MatchDocument(const std::string_view raw_query, int document_id) const {
-    
-    if (!documents_.count(document_id)) {
+    const auto it = document_to_index_.find(document_id);
+    if (it == document_to_index_.end()) {
         throw std::out_of_range("Нет такого документа"s);
     }
-    
-    const Query query = ParseQuery(raw_query, true);
-    
-    const auto status = documents_.at(document_id).status;
-    
-    std::vector<std::string_view> matched_words;
-    
-    for (const std::string_view word : query.minus_words) {
-        if (document_to_word_freqs_.at(document_id).count(word)) {
-            return {matched_words, status};
-        }
-    }
-    
-    matched_words.reserve(query.plus_words.size());
-    for (const std::string_view word : query.plus_words) {
-        if (document_to_word_freqs_.at(document_id).count(word)) {
-            matched_words.push_back(word);
-        }
-    }
-    return {matched_words, status};
+    return {MatchDocumentTerms(ParseQuery(raw_query, true), it->second), documents_[it->second].status};
 }
 
 matching_result SearchServer::MatchDocument(std::execution::sequenced_policy policy, const std::string_view raw_query, int document_id) const {
     return MatchDocument(raw_query, document_id);
 }
 
-matching_result SearchServer::MatchDocument(std::execution::parallel_policy policy, const std::string_view raw_query, int document_id) const {
-    
-    if (!documents_.count(document_id)) {
-        throw std::out_of_range("Нет такого документа"s);
+matching_result SearchServer::MatchDocument(std::execution::parallel_policy, const std::string_view raw_query, int document_id) const {
+    return MatchDocument(raw_query, document_id);
+}
+
+MatchedDocuments SearchServer::MatchDocuments(const std::string_view raw_query) const {
+    return MatchDocuments(std::execution::seq, raw_query);
+}
+
+MatchedDocuments SearchServer::MatchDocuments(std::execution::sequenced_policy policy, const std::string_view raw_query) const {
+    return MatchDocumentsImpl(policy, raw_query, GetDocumentIndices());
+}
+
+MatchedDocuments SearchServer::MatchDocuments(std::execution::parallel_policy policy, const std::string_view raw_query) const {
+    return MatchDocumentsImpl(policy, raw_query, GetDocumentIndices());
+}
+
+MatchedDocuments SearchServer::MatchDocuments(const std::string_view raw_query, const std::vector<int>& document_ids) const {
+    return MatchDocuments(std::execution::seq, raw_query, document_ids);
+}
+
+MatchedDocuments SearchServer::MatchDocuments(std::execution::sequenced_policy policy, const std::string_view raw_query, const std::vector<int>& document_ids) const {
+    return MatchDocumentsImpl(policy, raw_query, GetDocumentIndices(document_ids));
+}
+
+MatchedDocuments SearchServer::MatchDocuments(std::execution::parallel_policy policy, const std::string_view raw_query, const std::vector<int>& document_ids) const {
+    return MatchDocumentsImpl(policy, raw_query, GetDocumentIndices(document_ids));
+}
+
+std::vector<int> SearchServer::GetDocumentIndices() const {
+    std::vector<int> document_indices;
+    document_indices.reserve(document_to_index_.size());
+    for (const auto [document_id, document_index] : document_to_index_) {
+        document_indices.push_back(document_index);
     }
-    
-    const Query query = ParseQuery(raw_query, false);
-    
-    const auto status = documents_.at(document_id).status;
-    
-    const auto word_check = [this, document_id] (const std::string_view word) {return document_to_word_freqs_.at(document_id).count(word);};
-    
-    std::vector<std::string_view> words;
-    
-    for (const std::string_view word : query.minus_words) {
-        if (document_to_word_freqs_.at(document_id).count(word)) {
-            return {words, status};
+    return document_indices;
+}
+
+std::vector<int> SearchServer::GetDocumentIndices(const std::vector<int>& document_ids) const {
+    std::vector<int> document_indices(document_ids.size());
+    std::transform(document_ids.begin(), document_ids.end(), document_indices.begin(), [this](int document_id) {
+        const auto it = document_to_index_.find(document_id);
+        if (it == document_to_index_.end()) {
+            throw std::out_of_range("Нет такого документа"s);
         }
-    } // здесь это работает быстрее чем алгоритмы типа any_of с execution::par
-    
-    std::vector<std::string_view> matched_words(query.plus_words.size());
-    auto words_end = std::copy_if(policy, query.plus_words.begin(), query.plus_words.end(), matched_words.begin(), word_check);
-    std::sort(policy, matched_words.begin(), words_end);
-    matched_words.erase(std::unique(matched_words.begin(), words_end), matched_words.end());
-    return {matched_words, status};
+        return it->second;
+    });
+    return document_indices;
+}
+
+template <class ExecutionPolicy>
+MatchedDocuments SearchServer::MatchDocumentsImpl(ExecutionPolicy&& policy, const std::string_view raw_query, const std::vector<int>& document_indices) const {
+    Query query = ParseQuery(raw_query, true);
+    std::sort(query.plus_words.begin(), query.plus_words.end(), [this](TermId lhs, TermId rhs) {
+        return dictionary_.GetWord(lhs) < dictionary_.GetWord(rhs);
+    });
+
+    const int document_bound = static_cast<int>(documents_.size());
+    std::vector<int> document_to_slot(document_bound, -1);
+    std::vector<size_t> position_to_slot(document_indices.size());
+    for (size_t position = 0; position < document_indices.size(); ++position) {
+        int& slot = document_to_slot[document_indices[position]];
+        if (slot < 0) {
+            slot = static_cast<int>(position);
+        }
+        position_to_slot[position] = slot;
+    }
+
+    const auto for_each_posting = [this, &document_to_slot](const std::vector<TermId>& terms, std::pair<int, int> range, auto func) {
+        ForEachSegment(range.first, range.second, [&](const IndexSegment& segment) {
+            for (size_t rank = 0; rank < terms.size(); ++rank) {
+                const PostingListView postings = segment.Find(terms[rank]);
+                if (postings.empty()) {
+                    continue;
+                }
+                PostingCursor cursor(postings);
+                for (cursor.NextGeq(range.first); !cursor.IsEnd() && cursor.GetDocumentIndex() < range.second; cursor.Next()) {
+                    const int slot = document_to_slot[cursor.GetDocumentIndex()];
+                    if (slot >= 0) {
+                        func(cursor.GetDocumentIndex(), slot, rank);
+                    }
+                }
+            }
+        });
+    };
+
+    std::vector<std::pair<int, int>> ranges{{0, document_bound}};
+    if constexpr (!std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy>) {
+        ranges = SplitDocumentRanges();
+    }
+    std::vector<size_t> word_counts(document_indices.size());
+    ValidateSegments();
+    std::for_each(policy, ranges.begin(), ranges.end(), [&](std::pair<int, int> range) {
+        for_each_posting(query.minus_words, range, [&document_to_slot](int document_index, int, size_t) {
+            document_to_slot[document_index] = -1;
+        });
+        for_each_posting(query.plus_words, range, [&word_counts](int, int slot, size_t) {
+            ++word_counts[slot];
+        });
+    });
+
+    std::vector<size_t> next_word(document_indices.size());
+    size_t word_count = 0;
+    for (size_t slot = 0; slot < word_counts.size(); ++slot) {
+        next_word[slot] = word_count;
+        word_count += word_counts[slot];
+    }
+    std::vector<std::string_view> words(word_count);
+    std::vector<std::string_view> query_words(query.plus_words.size());
+    std::transform(query.plus_words.begin(), query.plus_words.end(), query_words.begin(), [this](TermId term) {
+        return dictionary_.GetWord(term);
+    });
+    std::for_each(policy, ranges.begin(), ranges.end(), [&](std::pair<int, int> range) {
+        for_each_posting(query.plus_words, range, [&](int, int slot, size_t rank) {
+            words[next_word[slot]++] = query_words[rank];
+        });
+    });
+
+    std::vector<MatchedDocuments::Entry> entries(document_indices.size());
+    for (size_t position = 0; position < document_indices.size(); ++position) {
+        const DocumentData& document_data = documents_[document_indices[position]];
+        const size_t slot = position_to_slot[position];
+        entries[position] = {document_data.id, document_data.status, next_word[slot] - word_counts[slot], next_word[slot]};
+    }
+    return {std::move(entries), std::move(words)};
 }
 
 std::set<int>::const_iterator SearchServer::begin() const {
@@ -160,14 +670,12 @@ bool SearchServer::IsStopWord(const std::string_view word) const {
     return stop_words_.count(word) > 0;
 }
 
-std::vector<std::string_view> SearchServer::SplitIntoWordsNoStop(const std::string_view text) const {
-    std::vector<std::string_view> words;
-    for (const std::string_view word : SplitIntoWords(text)) {
-        if (!IsStopWord(word)) {
-            words.push_back(word);
-        }
-    }
-    return words;
+bool SearchServer::SplitIntoWordsNoStop(const std::string_view text, std::vector<std::string_view>& words) const {
+    const bool is_valid = SplitIntoValidWords(text, words);
+    words.erase(std::remove_if(words.begin(), words.end(), [this](const std::string_view word) {
+        return IsStopWord(word);
+    }), words.end());
+    return is_valid;
 }
 
 int SearchServer::ComputeAverageRating(const std::vector<int>& ratings) {
@@ -179,9 +687,6 @@ int SearchServer::ComputeAverageRating(const std::vector<int>& ratings) {
 
 SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view text) const {
     bool is_minus = false;
-    if (!IsValidWord(text)) {
-        throw std::invalid_argument("Некорректный ввод: "s + std::string(text));
-    }
     if (text[0] == '-') {
         is_minus = true;
         text.remove_prefix(1);
@@ -194,10 +699,19 @@ SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view text) cons
 
 SearchServer::Query SearchServer::ParseQuery(const std::string_view text, bool sorted) const {
     Query query;
-    for (const std::string_view word : SplitIntoWords(text)) {
+    thread_local std::vector<std::string_view> words;
+    const bool is_valid = SplitIntoValidWords(text, words);
+    for (const std::string_view word : words) {
+        if (!is_valid && !IsValidWord(word)) {
+            throw std::invalid_argument("Некорректный ввод: "s + std::string(word));
+        }
         const QueryWord query_word = ParseQueryWord(word);
-        if (!query_word.is_stop) {
-            query_word.is_minus ? query.minus_words.push_back(query_word.data) : query.plus_words.push_back(query_word.data);
+        if (query_word.is_stop) {
+            continue;
+        }
+        const TermId term = dictionary_.Find(query_word.data);
+        if (term != TermDictionary::NO_TERM) {
+            query_word.is_minus ? query.minus_words.push_back(term) : query.plus_words.push_back(term);
         }
     }
     
@@ -211,6 +725,349 @@ SearchServer::Query SearchServer::ParseQuery(const std::string_view text, bool s
     return query;
 }
 
-double SearchServer::ComputeWordInverseDocumentFreq(const std::string_view word) const {
-    return log(GetDocumentCount() * 1.0 / word_to_document_freqs_.at(word).size());
-}
\ No newline at end of file
+std::vector<std::pair<int, int>> SearchServer::SplitDocumentRanges() const {
+    const int document_bound = static_cast<int>(documents_.size());
+    const int max_range_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) * 4);
+    const int range_count = std::clamp(document_bound / MIN_PARALLEL_RANGE_SIZE, 1, max_range_count);
+    const int range_size = std::max(1, (document_bound + range_count - 1) / range_count);
+    std::vector<std::pair<int, int>> ranges;
+    ranges.reserve(range_count);
+    for (int first = 0; first < document_bound || ranges.empty(); first += range_size) {
+        ranges.emplace_back(first, std::min(first + range_size, document_bound));
+    }
+    return ranges;
+}
+
+size_t SearchServer::GetQueryCost(const Query& query) const {
+    size_t cost = 0;
+    for (const TermId term : query.plus_words) {
+        cost += statistics_.GetDocumentFreq(term);
+    }
+    for (const TermId term : query.minus_words) {
+        cost += statistics_.GetDocumentFreq(term);
+    }
+    return cost;
+}
+
+std::optional<SearchServer::CandidateDocuments> SearchServer::SelectCandidates(const DocumentFilter& filter) const {
+    std::array<bool, DOCUMENT_STATUS_COUNT> is_allowed_status{};
+    for (const DocumentStatus status : filter.statuses) {
+        is_allowed_status[static_cast<size_t>(status)] = true;
+    }
+    if (filter.statuses.empty()) {
+        is_allowed_status.fill(true);
+    }
+    size_t status_count = 0;
+    for (size_t status = 0; status < DOCUMENT_STATUS_COUNT; ++status) {
+        if (is_allowed_status[status]) {
+            status_count += status_documents_[status].count();
+        }
+    }
+
+    const auto id_first = document_to_index_.lower_bound(filter.min_document_id);
+    const auto id_last = filter.max_document_id < filter.min_document_id ? id_first : document_to_index_.upper_bound(filter.max_document_id);
+    const auto count_up_to = [](auto first, auto last, size_t limit) {
+        size_t count = 0;
+        for (; first != last && count < limit; ++first) {
+            ++count;
+        }
+        return count;
+    };
+    const bool has_rating_range = filter.min_rating != std::numeric_limits<int>::min() || filter.max_rating != std::numeric_limits<int>::max();
+    const bool has_id_range = filter.min_document_id > 0 || filter.max_document_id != std::numeric_limits<int>::max();
+    const size_t candidate_limit = document_ids_.size() / MIN_CANDIDATE_SELECTIVITY;
+    const size_t rating_count = has_rating_range ? rating_index_.CountInRange(filter.min_rating, filter.max_rating) : std::numeric_limits<size_t>::max();
+    const size_t id_count = has_id_range ? count_up_to(id_first, id_last, std::min(candidate_limit, rating_count) + 1) : std::numeric_limits<size_t>::max();
+    const size_t candidate_count = std::min({status_count, rating_count, id_count});
+    if (candidate_count > candidate_limit) {
+        return std::nullopt;
+    }
+
+    CandidateDocuments candidates;
+    const auto add_candidate = [&](int document_index) {
+        const DocumentData& document_data = documents_[document_index];
+        if (!document_data.is_removed && is_allowed_status[static_cast<size_t>(document_data.status)]
+            && document_data.id >= filter.min_document_id && document_data.id <= filter.max_document_id
+            && document_data.rating >= filter.min_rating && document_data.rating <= filter.max_rating) {
+            candidates.document_indices.push_back(document_index);
+        }
+    };
+    if (candidate_count == rating_count) {
+        rating_index_.ForEachInRange(filter.min_rating, filter.max_rating, add_candidate);
+        std::sort(candidates.document_indices.begin(), candidates.document_indices.end());
+    } else if (candidate_count == id_count) {
+        for (auto it = id_first; it != id_last; ++it) {
+            add_candidate(it->second);
+        }
+        std::sort(candidates.document_indices.begin(), candidates.document_indices.end());
+    } else {
+        for (size_t word = 0; word * 64 < documents_.size(); ++word) {
+            uint64_t bits = 0;
+            for (size_t status = 0; status < DOCUMENT_STATUS_COUNT; ++status) {
+                if (is_allowed_status[status]) {
+                    bits |= status_documents_[status].GetWord(word);
+                }
+            }
+            for (; bits != 0; bits &= bits - 1) {
+                add_candidate(static_cast<int>(word * 64 + __builtin_ctzll(bits)));
+            }
+        }
+    }
+    for (const int document_index : candidates.document_indices) {
+        candidates.documents.Set(document_index);
+    }
+    return candidates;
+}
+
+bool SearchServer::IsPruningEffective(const Query& query) const {
+    if (query.plus_words.size() < 2) {
+        return false;
+    }
+    size_t total_size = 0;
+    size_t max_size = 0;
+    for (const TermId term : query.plus_words) {
+        const size_t size = statistics_.GetDocumentFreq(term);
+        total_size += size;
+        max_size = std::max(max_size, size);
+    }
+    return max_size > PRUNING_MIN_LIST_SKEW * (total_size - max_size);
+}
+
+const SearchServer::DocumentData& SearchServer::GetDocumentData(int document_id) const {
+    const auto it = document_to_index_.find(document_id);
+    if (it == document_to_index_.end()) {
+        throw std::out_of_range("Нет такого документа"s);
+    }
+    return documents_[it->second];
+}
+
+std::vector<std::string_view> SearchServer::MatchDocumentTerms(const Query& query, int document_index) const {
+    const DocumentTerms terms = forward_index_.Get(document_index);
+    const auto contains = [&terms](const std::vector<TermId>& query_terms, auto on_match) {
+        auto term_it = terms.begin();
+        for (const TermId term : query_terms) {
+            while (term_it != terms.end() && term_it->term < term) {
+                ++term_it;
+            }
+            if (term_it == terms.end()) {
+                return;
+            }
+            if (term_it->term == term && on_match(term)) {
+                return;
+            }
+        }
+    };
+    std::vector<std::string_view> matched_words;
+    bool has_minus_word = false;
+    contains(query.minus_words, [&has_minus_word](TermId) {
+        return has_minus_word = true;
+    });
+    if (has_minus_word) {
+        return matched_words;
+    }
+    contains(query.plus_words, [&](TermId term) {
+        matched_words.push_back(dictionary_.GetWord(term));
+        return false;
+    });
+    std::sort(matched_words.begin(), matched_words.end());
+    return matched_words;
+}
+
+void SearchServer::ReleaseTermIfUnused(TermId term) {
+    if (statistics_.GetDocumentFreq(term) == 0) {
+        dictionary_.Release(term);
+    }
+}
+
+void SearchServer::RecycleReleasedTerms() {
+    dictionary_.RecycleReleased([this](TermId term) {
+        return !mutable_segment_.Find(term).empty() || std::any_of(sealed_segments_.begin(), sealed_segments_.end(), [term](const SegmentSlot& slot) {
+            return !slot.segment->Find(term).empty();
+        });
+    });
+}
+void SearchServer::MarkDocumentRemoved(std::map<int, int>::iterator document_it) {
+    const int document_id = document_it->first;
+    const int document_index = document_it->second;
+    documents_[document_index].is_removed = true;
+    status_documents_[static_cast<size_t>(documents_[document_index].status)].Reset(document_index);
+    rating_index_.Remove([this](int removed_index) {
+        return documents_[removed_index].is_removed;
+    });
+    const auto slot = std::upper_bound(sealed_segments_.begin(), sealed_segments_.end(), document_index, [](int index, const SegmentSlot& slot) {
+        return index < slot.segment->GetFirstDocumentIndex();
+    });
+    if (slot != sealed_segments_.begin() && document_index < mutable_segment_.GetFirstDocumentIndex()) {
+        ++std::prev(slot)->removed_count;
+    }
+    forward_index_.Remove(document_index);
+    document_to_index_.erase(document_it);
+    document_ids_.erase(document_id);
+    statistics_.SetDocumentCount(GetDocumentCount());
+    ++epoch_;
+    CollectSegmentMerge(false);
+    CompactDocumentIndices();
+    ScheduleSegmentMerge();
+}
+
+template <class ExecutionPolicy>
+void SearchServer::CompactSegments(ExecutionPolicy&& policy) {
+    std::vector<size_t> slots;
+    for (size_t slot = 0; slot < sealed_segments_.size(); ++slot) {
+        if (segment_merge_ && slot >= segment_merge_->first_slot && slot < segment_merge_->first_slot + segment_merge_->slot_count) {
+            continue;
+        }
+        const auto& segment = *sealed_segments_[slot].segment;
+        if (sealed_segments_[slot].removed_count * 2 > segment.GetLastDocumentIndex() - segment.GetFirstDocumentIndex()) {
+            slots.push_back(slot);
+        }
+    }
+    ValidateSegments();
+    std::for_each(policy, slots.begin(), slots.end(), [this](size_t slot) {
+        const auto& segment = sealed_segments_[slot].segment;
+        const int first_index = segment->GetFirstDocumentIndex();
+        const int last_index = segment->GetLastDocumentIndex();
+        std::vector<bool> tombstones(last_index - first_index);
+        std::vector<double> inv_word_counts(last_index - first_index);
+        for (int document_index = first_index; document_index < last_index; ++document_index) {
+            tombstones[document_index - first_index] = documents_[document_index].is_removed;
+            inv_word_counts[document_index - first_index] = documents_[document_index].inv_word_count;
+        }
+        sealed_segments_[slot] = {std::make_shared<const IndexSegment>(IndexSegment::Merge({segment}, tombstones, inv_word_counts)), 0};
+    });
+    if (!slots.empty()) {
+        RecycleReleasedTerms();
+    }
+}
+
+void SearchServer::SealMutableSegment(int last_document_index) {
+    mutable_segment_.Seal(last_document_index);
+    sealed_segments_.push_back({std::make_shared<const IndexSegment>(std::move(mutable_segment_)), 0});
+    for (int document_index = sealed_segments_.back().segment->GetFirstDocumentIndex(); document_index < last_document_index; ++document_index) {
+        sealed_segments_.back().removed_count += documents_[document_index].is_removed;
+    }
+    mutable_segment_ = IndexSegment(last_document_index);
+}
+
+void SearchServer::CompactDocumentIndices() {
+    const int removed_count = static_cast<int>(documents_.size()) - GetDocumentCount();
+    if (removed_count < MIN_COMPACTION_REMOVED_COUNT || removed_count <= GetDocumentCount()) {
+        return;
+    }
+    while (segment_merge_) {
+        CollectSegmentMerge(true);
+    }
+    if (static_cast<int>(documents_.size()) > mutable_segment_.GetFirstDocumentIndex()) {
+        SealMutableSegment(static_cast<int>(documents_.size()));
+    }
+    std::vector<int> new_indices(documents_.size(), -1);
+    std::vector<double> inv_word_counts(documents_.size());
+    std::vector<DocumentData> documents;
+    documents.reserve(GetDocumentCount());
+    for (size_t document_index = 0; document_index < documents_.size(); ++document_index) {
+        inv_word_counts[document_index] = documents_[document_index].inv_word_count;
+        if (!documents_[document_index].is_removed) {
+            new_indices[document_index] = static_cast<int>(documents.size());
+            documents.push_back(documents_[document_index]);
+        }
+    }
+    const int document_count = static_cast<int>(documents.size());
+    std::vector<SegmentSlot> segments;
+    if (document_count > 0) {
+        std::vector<std::shared_ptr<const IndexSegment>> merged_segments;
+        for (const SegmentSlot& slot : sealed_segments_) {
+            merged_segments.push_back(slot.segment);
+        }
+        segments.push_back({std::make_shared<const IndexSegment>(IndexSegment::Renumber(merged_segments, new_indices, inv_word_counts, 0, document_count)), 0});
+    }
+
+    sealed_segments_ = std::move(segments);
+    mutable_segment_ = IndexSegment(document_count);
+    forward_index_.Renumber(new_indices, documents.size());
+    documents_ = std::move(documents);
+    status_documents_ = {};
+    rating_index_ = RatingIndex();
+    for (int document_index = 0; document_index < document_count; ++document_index) {
+        const DocumentData& document = documents_[document_index];
+        status_documents_[static_cast<size_t>(document.status)].Set(document_index);
+        rating_index_.Add(document.rating, document_index);
+        document_to_index_[document.id] = document_index;
+    }
+    RecycleReleasedTerms();
+}
+
+void SearchServer::ValidateSegments() const {
+    for (const SegmentSlot& slot : sealed_segments_) {
+        slot.segment->EnsureValidated();
+    }
+}
+
+void SearchServer::ScheduleSegmentMerge() {
+    if (segment_merge_) {
+        return;
+    }
+    const auto get_tier = [](const SegmentSlot& slot) {
+        const int span = slot.segment->GetLastDocumentIndex() - slot.segment->GetFirstDocumentIndex();
+        int tier = 0;
+        for (long long tier_span = SEGMENT_SEAL_SIZE * static_cast<long long>(SEGMENT_MERGE_FACTOR); span >= tier_span; tier_span *= SEGMENT_MERGE_FACTOR) {
+            ++tier;
+        }
+        return tier;
+    };
+    for (size_t end_slot = sealed_segments_.size(); end_slot >= SEGMENT_MERGE_FACTOR; --end_slot) {
+        const auto first = sealed_segments_.begin() + (end_slot - SEGMENT_MERGE_FACTOR);
+        const int tier = get_tier(*first);
+        if (std::all_of(first, first + SEGMENT_MERGE_FACTOR, [&](const SegmentSlot& slot) { return get_tier(slot) == tier; })) {
+            StartSegmentMerge(first - sealed_segments_.begin(), SEGMENT_MERGE_FACTOR, std::launch::async);
+            return;
+        }
+    }
+    for (size_t slot = 0; slot < sealed_segments_.size(); ++slot) {
+        const auto& segment = *sealed_segments_[slot].segment;
+        if (sealed_segments_[slot].removed_count * 2 > segment.GetLastDocumentIndex() - segment.GetFirstDocumentIndex()) {
+            StartSegmentMerge(slot, 1, std::launch::async);
+            return;
+        }
+    }
+}
+
+void SearchServer::StartSegmentMerge(size_t first_slot, size_t slot_count, std::launch launch_policy) {
+    std::vector<std::shared_ptr<const IndexSegment>> segments;
+    int removed_count = 0;
+    for (size_t slot = first_slot; slot < first_slot + slot_count; ++slot) {
+        segments.push_back(sealed_segments_[slot].segment);
+        removed_count += sealed_segments_[slot].removed_count;
+    }
+    const int first_index = segments.front()->GetFirstDocumentIndex();
+    const int last_index = segments.back()->GetLastDocumentIndex();
+    std::vector<bool> tombstones(last_index - first_index);
+    std::vector<double> inv_word_counts(last_index - first_index);
+    for (int document_index = first_index; document_index < last_index; ++document_index) {
+        tombstones[document_index - first_index] = documents_[document_index].is_removed;
+        inv_word_counts[document_index - first_index] = documents_[document_index].inv_word_count;
+    }
+    auto result = std::async(launch_policy, [segments = std::move(segments), tombstones = std::move(tombstones), inv_word_counts = std::move(inv_word_counts)] {
+        return std::make_shared<const IndexSegment>(IndexSegment::Merge(segments, tombstones, inv_word_counts));
+    });
+    segment_merge_ = SegmentMerge{first_slot, slot_count, removed_count, result.share()};
+}
+
+void SearchServer::CollectSegmentMerge(bool wait) {
+    if (!segment_merge_) {
+        return;
+    }
+    if (!wait && segment_merge_->result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    const SegmentMerge merge = *segment_merge_;
+    segment_merge_.reset();
+    SegmentSlot merged{merge.result.get(), -merge.removed_count};
+    const auto first = sealed_segments_.begin() + merge.first_slot;
+    for (auto slot = first; slot != first + merge.slot_count; ++slot) {
+        merged.removed_count += slot->removed_count;
+    }
+    *first = std::move(merged);
+    sealed_segments_.erase(first + 1, first + merge.slot_count);
+    RecycleReleasedTerms();
+    ScheduleSegmentMerge();
+}
@@ -10,13 +10,34 @@
 #include <execution>
 #include <string_view>
 #include <type_traits>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <memory>
+#include <future>
+#include <optional>
+#include <array>
 
 #include "document.h"
+#include "document_bitmap.h"
 #include "string_processing.h"
-#include "concurrent_map.h"
+#include "posting_list.h"
+#include "index_segment.h"
+#include "term_dictionary.h"
+#include "collection_statistics.h"
+#include "forward_index.h"
+#include "matched_documents.h"
+#include "index_file.h"
+#include "top_documents.h"
+#include "relevance_accumulator.h"
+#include "rating_index.h"
 
 const int MAX_RESULT_DOCUMENT_COUNT = 5;
-const double EPSILON = 1e-6;
+const size_t PRUNING_MIN_LIST_SKEW = 2;
+const int MIN_PARALLEL_RANGE_SIZE = 4096;
+const size_t MIN_CANDIDATE_SKEW = 4;
+const size_t MIN_CANDIDATE_SELECTIVITY = 64;
+const int MIN_COMPACTION_REMOVED_COUNT = SEGMENT_SEAL_SIZE;
 
 class SearchServer {
 public:
@@ -28,23 +49,66 @@ public:
 
     void AddDocument (int document_id, const std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
 
+    void AddDocuments(const std::vector<DocumentInput>& documents);
+
+    void AddDocuments(std::execution::sequenced_policy policy, const std::vector<DocumentInput>& documents);
+
+    void AddDocuments(std::execution::parallel_policy policy, const std::vector<DocumentInput>& documents);
+
+    struct TokenizedDocument {
+        std::vector<std::pair<std::string_view, uint32_t>> word_counts;
+        double inv_word_count = 0.0;
+        bool is_valid = false;
+    };
+
+    // Не зависит от состояния индекса, поэтому может выполняться параллельно с добавлением документов
+    TokenizedDocument TokenizeDocument(const std::string_view document) const;
+
+    void AddDocuments(std::execution::parallel_policy policy, const std::vector<DocumentInput>& documents, std::vector<TokenizedDocument> tokenized_documents);
+
+    struct Query {
+        std::vector<TermId> plus_words;
+        std::vector<TermId> minus_words;
+    };
+
+    Query ParseQuery(const std::string_view text, bool sorted = true) const;
+
+    size_t GetQueryCost(const Query& query) const;
+
+    std::vector<std::pair<int, int>> SplitDocumentRanges() const;
+
+    template <typename DocumentPredicate>
+    TopDocuments FindTopDocumentsInRange(const Query& query, DocumentPredicate document_predicate, std::pair<int, int> range, size_t top_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(const Query& query, DocumentPredicate document_predicate, size_t top_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
     template <typename DocumentPredicate>
-    std::vector<Document> FindTopDocuments(const std::string_view raw_query, DocumentPredicate document_predicate) const;
+    TopDocuments CollectTopDocuments(const Query& query, DocumentPredicate document_predicate, size_t top_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(const Query& query, DocumentStatus status, size_t top_count = MAX_RESULT_DOCUMENT_COUNT) const;
 
-    std::vector<Document> FindTopDocuments(const std::string_view raw_query, DocumentStatus status) const;
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(const std::string_view raw_query, DocumentPredicate document_predicate, size_t top_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(const std::string_view raw_query, DocumentStatus status, size_t top_count = MAX_RESULT_DOCUMENT_COUNT) const;
 
     std::vector<Document> FindTopDocuments(const std::string_view raw_query) const;
     
     template <class ExecutionPolicy, typename DocumentPredicate>
-    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, const std::string_view raw_query, DocumentPredicate document_predicate) const;
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, const std::string_view raw_query, DocumentPredicate document_predicate, size_t top_count = MAX_RESULT_DOCUMENT_COUNT) const;
 
     template <class ExecutionPolicy>
-    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, const std::string_view raw_query, DocumentStatus status) const;
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, const std::string_view raw_query, DocumentStatus status, size_t top_count = MAX_RESULT_DOCUMENT_COUNT) const;
 
     template <class ExecutionPolicy>
     std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, const std::string_view raw_query) const;
 
     int GetDocumentCount() const;
+
+    int GetDocumentRating(int document_id) const;
+
+    uint64_t GetEpoch() const;
     
     using matching_result = std::tuple<std::vector<std::string_view>, DocumentStatus>;
 
@@ -53,8 +117,27 @@ public:
     matching_result MatchDocument(std::execution::sequenced_policy policy, const std::string_view raw_query, int document_id) const;
 
     matching_result MatchDocument(std::execution::parallel_policy policy, const std::string_view raw_query, int document_id) const;
+
+    MatchedDocuments MatchDocuments(const std::string_view raw_query) const;
+
+    MatchedDocuments MatchDocuments(std::execution::sequenced_policy policy, const std::string_view raw_query) const;
+
+    MatchedDocuments MatchDocuments(std::execution::parallel_policy policy, const std::string_view raw_query) const;
+
+    MatchedDocuments MatchDocuments(const std::string_view raw_query, const std::vector<int>& document_ids) const;
+
+    MatchedDocuments MatchDocuments(std::execution::sequenced_policy policy, const std::string_view raw_query, const std::vector<int>& document_ids) const;
+
+    MatchedDocuments MatchDocuments(std::execution::parallel_policy policy, const std::string_view raw_query, const std::vector<int>& document_ids) const;
     
-    const std::map<std::string_view, double>& GetWordFrequencies(int document_id) const;
+    // Результат ссылается на внутренние данные сервера, см. WordFrequencies
+    WordFrequencies GetWordFrequencies(int document_id) const;
+
+    DocumentSignature GetDocumentSignature(int document_id) const;
+
+    TermStatistics GetTermStatistics(const std::string_view word) const;
+
+    const CollectionStatistics& GetCollectionStatistics() const;
     
     std::set<int>::const_iterator begin() const;
     
@@ -65,23 +148,63 @@ public:
     void RemoveDocument(std::execution::sequenced_policy policy, int document_id);
     
     void RemoveDocument(std::execution::parallel_policy policy, int document_id);
-    
+
+    void RemoveDocuments(const std::vector<int>& document_ids);
+
+    void RemoveDocuments(std::execution::sequenced_policy policy, const std::vector<int>& document_ids);
+
+    void RemoveDocuments(std::execution::parallel_policy policy, const std::vector<int>& document_ids);
+
+    void MergeSegments();
+
+    size_t GetSegmentCount() const;
+
+    void Save(const std::string& path) const;
+
+    static SearchServer Load(const std::string& path);
 
 private:
     struct DocumentData {
+        int id;
         int rating;
         DocumentStatus status;
+        double inv_word_count;
+        bool is_removed = false;
+    };
+    struct SegmentSlot {
+        std::shared_ptr<const IndexSegment> segment;
+        int removed_count;
+    };
+    struct CandidateDocuments {
+        DocumentBitmap documents;
+        std::vector<int> document_indices;
+    };
+    struct CandidateFilter {
+        const CandidateDocuments* candidates;
+    };
+    struct SegmentMerge {
+        size_t first_slot;
+        size_t slot_count;
+        int removed_count;
+        std::shared_future<std::shared_ptr<const IndexSegment>> result;
     };
     const std::set<std::string, std::less<>> stop_words_;
-    std::map<std::string_view, std::map<int, double>> word_to_document_freqs_;
-    std::map<int, DocumentData> documents_;
-    std::map<int, std::map<std::string_view, double>> document_to_word_freqs_;
+    TermDictionary dictionary_;
+    CollectionStatistics statistics_;
+    std::vector<SegmentSlot> sealed_segments_;
+    IndexSegment mutable_segment_{0};
+    std::optional<SegmentMerge> segment_merge_;
+    std::vector<DocumentData> documents_;
+    std::map<int, int> document_to_index_;
+    ForwardIndex forward_index_;
+    std::array<DocumentBitmap, DOCUMENT_STATUS_COUNT> status_documents_;
+    RatingIndex rating_index_;
     std::set<int> document_ids_;
-    std::set<std::string> all_words_;
+    uint64_t epoch_ = 0;
 
     bool IsStopWord(const std::string_view word) const;
 
-    std::vector<std::string_view> SplitIntoWordsNoStop(const std::string_view text) const;
+    bool SplitIntoWordsNoStop(const std::string_view text, std::vector<std::string_view>& words) const;
 
     static int ComputeAverageRating(const std::vector<int>& ratings);
 
@@ -93,20 +216,72 @@ private:
 
     QueryWord ParseQueryWord(std::string_view text) const;
 
-    struct Query {
-        std::vector<std::string_view> plus_words;
-        std::vector<std::string_view> minus_words;
-    };
+    const DocumentData& GetDocumentData(int document_id) const;
+
+    std::optional<CandidateDocuments> SelectCandidates(const DocumentFilter& filter) const;
+
+    template <typename DocumentPredicate>
+    bool HasCandidateDocuments(const DocumentPredicate& document_predicate) const;
+
+    template <typename DocumentPredicate>
+    const DocumentData* FilterDocument(const DocumentPredicate& document_predicate, int document_index) const;
+
+    std::vector<std::string_view> MatchDocumentTerms(const Query& query, int document_index) const;
+
+    std::vector<int> GetDocumentIndices() const;
+
+    std::vector<int> GetDocumentIndices(const std::vector<int>& document_ids) const;
+
+    template <class ExecutionPolicy>
+    MatchedDocuments MatchDocumentsImpl(ExecutionPolicy&& policy, const std::string_view raw_query, const std::vector<int>& document_indices) const;
+
+    void ReleaseTermIfUnused(TermId term);
+
+    void RecycleReleasedTerms();
+
+    void MarkDocumentRemoved(std::map<int, int>::iterator document_it);
+
+    template <class ExecutionPolicy>
+    void AddDocumentsImpl(ExecutionPolicy&& policy, const std::vector<DocumentInput>& documents);
+
+    template <class ExecutionPolicy>
+    void AddTokenizedDocuments(ExecutionPolicy&& policy, const std::vector<DocumentInput>& documents, std::vector<TokenizedDocument> tokenized_documents);
+
+    template <class ExecutionPolicy>
+    void RemoveDocumentsImpl(ExecutionPolicy&& policy, const std::vector<int>& document_ids);
+
+    template <class ExecutionPolicy>
+    void CompactSegments(ExecutionPolicy&& policy);
+
+    void SealMutableSegment(int last_document_index);
+
+    void ScheduleSegmentMerge();
+
+    void StartSegmentMerge(size_t first_slot, size_t slot_count, std::launch launch_policy);
+
+    void CollectSegmentMerge(bool wait);
+
+    // Когда удалённых документов больше, чем живых, перенумеровывает живые документы подряд,
+    // чтобы индексное пространство не росло при удалении и повторном добавлении
+    void CompactDocumentIndices();
 
-    Query ParseQuery(const std::string_view text, bool sorted) const;
+    // Исключение внутри параллельного алгоритма завершило бы программу, поэтому загруженные сегменты проверяются до него
+    void ValidateSegments() const;
 
-    double ComputeWordInverseDocumentFreq(const std::string_view word) const;
+    template <typename Func>
+    void ForEachSegment(int first_index, int last_index, Func func) const;
+
+    template <typename DocumentPredicate, typename DocumentConsumer>
+    void ScoreDocumentRange(const Query& query, DocumentPredicate document_predicate, int first_index, int last_index, DocumentConsumer consumer) const;
 
     template <typename DocumentPredicate>
     std::vector<Document> FindAllDocuments(const Query& query, DocumentPredicate document_predicate) const;
-    
-    template <class ExecutionPolicy, typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(ExecutionPolicy&& policy, const Query& query, DocumentPredicate document_predicate) const;
+
+    bool IsPruningEffective(const Query& query) const;
+
+    template <typename DocumentPredicate>
+    TopDocuments FindTopDocumentsPruned(const Query& query, DocumentPredicate document_predicate, size_t top_count) const;
+
 };
 
 template <typename StringContainer>
@@ -115,39 +290,90 @@ SearchServer::SearchServer(const StringContainer& stop_words)
 }
 
 template <typename DocumentPredicate>
-std::vector<Document> SearchServer::FindTopDocuments(const std::string_view raw_query, DocumentPredicate document_predicate) const {
-    const Query query = ParseQuery(raw_query, true);
-    auto matched_documents = FindAllDocuments(query, document_predicate);
-
-    sort(matched_documents.begin(), matched_documents.end(), [](const Document& lhs, const Document& rhs) {
-        return std::abs(lhs.relevance - rhs.relevance) < EPSILON ? (lhs.rating > rhs.rating) : (lhs.relevance > rhs.relevance);
+TopDocuments SearchServer::FindTopDocumentsInRange(const Query& query, DocumentPredicate document_predicate, std::pair<int, int> range, size_t top_count) const {
+    TopDocuments top_documents(top_count);
+    ScoreDocumentRange(query, document_predicate, range.first, range.second, [&top_documents](const Document& document) {
+        top_documents.Add(document);
     });
-    if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
-        matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
+    return top_documents;
+}
+
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(const std::string_view raw_query, DocumentPredicate document_predicate, size_t top_count) const {
+    return FindTopDocuments(ParseQuery(raw_query, true), document_predicate, top_count);
+}
+
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(const Query& query, DocumentPredicate document_predicate, size_t top_count) const {
+    if constexpr (std::is_same_v<DocumentPredicate, DocumentFilter>) {
+        const auto candidates = SelectCandidates(document_predicate);
+        if (!candidates) {
+            return FindTopDocuments(query, [&document_predicate](int document_id, DocumentStatus status, int rating) {
+                return document_predicate(document_id, status, rating);
+            }, top_count);
+        }
+        return FindTopDocuments(query, CandidateFilter{&*candidates}, top_count);
+    } else {
+        if (!HasCandidateDocuments(document_predicate)) {
+            return {};
+        }
+        // Кандидатов не больше 1/MIN_CANDIDATE_SELECTIVITY документов, их прямой перебор дешевле отсечения
+        if constexpr (!std::is_same_v<DocumentPredicate, CandidateFilter>) {
+            if (IsPruningEffective(query)) {
+                return FindTopDocumentsPruned(query, document_predicate, top_count).Release();
+            }
+        }
+        return SelectTopDocuments(FindAllDocuments(query, document_predicate), top_count);
     }
-    return matched_documents;
 }
 
-template <class ExecutionPolicy, typename DocumentPredicate>
-std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, const std::string_view raw_query, DocumentPredicate document_predicate) const {
-    const Query query = ParseQuery(raw_query, true);
-    auto matched_documents = FindAllDocuments(policy, query, document_predicate);
+template <typename DocumentPredicate>
+TopDocuments SearchServer::CollectTopDocuments(const Query& query, DocumentPredicate document_predicate, size_t top_count) const {
+    if (!HasCandidateDocuments(document_predicate)) {
+        return TopDocuments(top_count);
+    }
+    if (IsPruningEffective(query)) {
+        return FindTopDocumentsPruned(query, document_predicate, top_count);
+    }
+    return FindTopDocumentsInRange(query, document_predicate, {0, static_cast<int>(documents_.size())}, top_count);
+}
 
-    sort(matched_documents.begin(), matched_documents.end(), [](const Document& lhs, const Document& rhs) {
-        return std::abs(lhs.relevance - rhs.relevance) < EPSILON ? (lhs.rating > rhs.rating) : (lhs.relevance > rhs.relevance);
-    });
-    if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
-        matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
+template <class ExecutionPolicy, typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, const std::string_view raw_query, DocumentPredicate document_predicate, size_t top_count) const {
+    if constexpr (std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy>) {
+        return FindTopDocuments(raw_query, document_predicate, top_count);
+    } else if constexpr (std::is_same_v<DocumentPredicate, DocumentFilter>) {
+        const auto candidates = SelectCandidates(document_predicate);
+        if (!candidates) {
+            return FindTopDocuments(policy, raw_query, [&document_predicate](int document_id, DocumentStatus status, int rating) {
+                return document_predicate(document_id, status, rating);
+            }, top_count);
+        }
+        return FindTopDocuments(policy, raw_query, CandidateFilter{&*candidates}, top_count);
+    } else {
+        const Query query = ParseQuery(raw_query, true);
+        if (!HasCandidateDocuments(document_predicate)) {
+            return {};
+        }
+        const auto ranges = SplitDocumentRanges();
+        std::vector<TopDocuments> range_tops(ranges.size(), TopDocuments(top_count));
+        std::vector<size_t> range_numbers(ranges.size());
+        std::iota(range_numbers.begin(), range_numbers.end(), 0);
+        ValidateSegments();
+        std::for_each(policy, range_numbers.begin(), range_numbers.end(), [&](size_t range) {
+            range_tops[range] = FindTopDocumentsInRange(query, document_predicate, ranges[range], top_count);
+        });
+        for (size_t range = 1; range < range_tops.size(); ++range) {
+            range_tops.front().Merge(range_tops[range]);
+        }
+        return range_tops.front().Release();
     }
-    return matched_documents;
 }
 
 
 template <class ExecutionPolicy>
-std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, const std::string_view raw_query, DocumentStatus status) const {
-    return FindTopDocuments(policy, raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
-        return document_status == status;
-    });
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, const std::string_view raw_query, DocumentStatus status, size_t top_count) const {
+    return FindTopDocuments(policy, raw_query, DocumentStatusFilter{status}, top_count);
 }
 
 template <class ExecutionPolicy>
@@ -156,66 +382,214 @@ std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, c
 }
 
 template <typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const Query& query, DocumentPredicate document_predicate) const {
-    std::map<int, double> document_to_relevance;
-    for (const std::string_view word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
+bool SearchServer::HasCandidateDocuments(const DocumentPredicate& document_predicate) const {
+    if constexpr (std::is_same_v<DocumentPredicate, DocumentStatusFilter>) {
+        return status_documents_[static_cast<size_t>(document_predicate.status)].count() > 0;
+    } else if constexpr (std::is_same_v<DocumentPredicate, CandidateFilter>) {
+        return !document_predicate.candidates->document_indices.empty();
+    } else {
+        return !document_ids_.empty();
+    }
+}
+
+template <typename DocumentPredicate>
+const SearchServer::DocumentData* SearchServer::FilterDocument(const DocumentPredicate& document_predicate, int document_index) const {
+    if constexpr (std::is_same_v<DocumentPredicate, DocumentStatusFilter>) {
+        if (!status_documents_[static_cast<size_t>(document_predicate.status)].Test(document_index)) {
+            return nullptr;
         }
-        const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-        for (const auto [document_id, term_freq] : word_to_document_freqs_.at(word)) {
-            const auto& document_data = documents_.at(document_id);
-            if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                document_to_relevance[document_id] += term_freq * inverse_document_freq;
+        return &documents_[document_index];
+    } else if constexpr (std::is_same_v<DocumentPredicate, CandidateFilter>) {
+        if (!document_predicate.candidates->documents.Test(document_index)) {
+            return nullptr;
+        }
+        return &documents_[document_index];
+    } else {
+        const DocumentData& document_data = documents_[document_index];
+        if (document_data.is_removed) {
+            return nullptr;
+        }
+        if constexpr (!std::is_same_v<DocumentPredicate, AnyDocumentFilter>) {
+            if (!document_predicate(document_data.id, document_data.status, document_data.rating)) {
+                return nullptr;
             }
         }
+        return &document_data;
     }
+}
 
-    for (const std::string_view word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
+template <typename Func>
+void SearchServer::ForEachSegment(int first_index, int last_index, Func func) const {
+    for (const SegmentSlot& slot : sealed_segments_) {
+        if (slot.segment->GetFirstDocumentIndex() < last_index && slot.segment->GetLastDocumentIndex() > first_index) {
+            func(*slot.segment);
         }
-        for (const auto [document_id, _] : word_to_document_freqs_.at(word)) {
-            document_to_relevance.erase(document_id);
+    }
+    if (mutable_segment_.GetFirstDocumentIndex() < last_index) {
+        func(mutable_segment_);
+    }
+}
+
+template <typename DocumentPredicate, typename DocumentConsumer>
+void SearchServer::ScoreDocumentRange(const Query& query, DocumentPredicate document_predicate, int first_index, int last_index, DocumentConsumer consumer) const {
+    auto& document_to_relevance = RelevanceAccumulator::ForCurrentThread(last_index - first_index);
+    ForEachSegment(first_index, last_index, [&](const IndexSegment& segment) {
+        for (const TermId term : query.minus_words) {
+            const PostingListView postings = segment.Find(term);
+            if (postings.empty()) {
+                continue;
+            }
+            PostingCursor cursor(postings);
+            for (cursor.NextGeq(first_index); !cursor.IsEnd() && cursor.GetDocumentIndex() < last_index; cursor.Next()) {
+                document_to_relevance.Exclude(cursor.GetDocumentIndex() - first_index);
+            }
         }
+    });
+
+    for (const TermId term : query.plus_words) {
+        const double inverse_document_freq = statistics_.GetInverseDocumentFreq(term);
+        ForEachSegment(first_index, last_index, [&](const IndexSegment& segment) {
+            const PostingListView postings = segment.Find(term);
+            if (postings.empty()) {
+                return;
+            }
+            PostingCursor cursor(postings);
+            if constexpr (std::is_same_v<DocumentPredicate, CandidateFilter>) {
+                const std::vector<int>& candidates = document_predicate.candidates->document_indices;
+                if (candidates.size() * MIN_CANDIDATE_SKEW < postings.size()) {
+                    const int first_candidate = std::max(first_index, segment.GetFirstDocumentIndex());
+                    for (auto candidate = std::lower_bound(candidates.begin(), candidates.end(), first_candidate); candidate != candidates.end() && *candidate < last_index; ++candidate) {
+                        cursor.NextGeq(*candidate);
+                        if (cursor.IsEnd()) {
+                            break;
+                        }
+                        if (cursor.GetDocumentIndex() == *candidate && !document_to_relevance.IsExcluded(*candidate - first_index)) {
+                            document_to_relevance.Add(*candidate - first_index, cursor.GetTermCount() * documents_[*candidate].inv_word_count * inverse_document_freq);
+                        }
+                    }
+                    return;
+                }
+            }
+            for (cursor.NextGeq(first_index); !cursor.IsEnd() && cursor.GetDocumentIndex() < last_index; cursor.Next()) {
+                const int document_index = cursor.GetDocumentIndex();
+                if (document_to_relevance.IsExcluded(document_index - first_index)) {
+                    continue;
+                }
+                if (const DocumentData* document_data = FilterDocument(document_predicate, document_index)) {
+                    document_to_relevance.Add(document_index - first_index, cursor.GetTermCount() * document_data->inv_word_count * inverse_document_freq);
+                }
+            }
+        });
     }
 
+    document_to_relevance.ForEach([&](int offset, double relevance) {
+        const auto& document_data = documents_[first_index + offset];
+        consumer(Document{document_data.id, relevance, document_data.rating});
+    });
+}
+
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindAllDocuments(const Query& query, DocumentPredicate document_predicate) const {
     std::vector<Document> matched_documents;
-    for (const auto [document_id, relevance] : document_to_relevance) {
-        matched_documents.push_back({document_id, relevance, documents_.at(document_id).rating});
-    }
+    ScoreDocumentRange(query, document_predicate, 0, static_cast<int>(documents_.size()), [&matched_documents](const Document& document) {
+        matched_documents.push_back(document);
+    });
     return matched_documents;
 }
 
-template <class ExecutionPolicy, typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(ExecutionPolicy&& policy, const Query& query, DocumentPredicate document_predicate) const {
-    ConcurrentMap<int, double> document_to_relevance(10);
-    
-    std::for_each(policy, query.plus_words.begin(), query.plus_words.end(), [&] (auto word) {
-        if (word_to_document_freqs_.count(word) > 0) {
-            const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-            for (const auto [document_id, term_freq] : word_to_document_freqs_.at(word)) {
-                const auto& document_data = documents_.at(document_id);
-                if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                    document_to_relevance[document_id].ref_to_value += term_freq * inverse_document_freq;
-                }
+template <typename DocumentPredicate>
+TopDocuments SearchServer::FindTopDocumentsPruned(const Query& query, DocumentPredicate document_predicate, size_t top_count) const {
+    const int document_bound = static_cast<int>(documents_.size());
+    auto& excluded = RelevanceAccumulator::ForCurrentThread(document_bound);
+    ForEachSegment(0, document_bound, [&](const IndexSegment& segment) {
+        for (const TermId term : query.minus_words) {
+            for (const auto [document_index, _] : segment.Find(term)) {
+                excluded.Exclude(document_index);
             }
         }
-    } );
-    
+    });
 
-    for (const std::string_view word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
+    std::vector<double> inverse_document_freqs(query.plus_words.size());
+    std::transform(query.plus_words.begin(), query.plus_words.end(), inverse_document_freqs.begin(), [this](TermId term) {
+        return statistics_.GetInverseDocumentFreq(term);
+    });
+
+    struct TermCursor {
+        PostingCursor cursor;
+        double inverse_document_freq;
+        double max_relevance;
+    };
+    std::vector<TermCursor> cursors;
+    std::vector<double> max_relevance_prefix;
+    TopDocuments top_documents(top_count);
+    ForEachSegment(0, document_bound, [&](const IndexSegment& segment) {
+        cursors.clear();
+        for (size_t i = 0; i < query.plus_words.size(); ++i) {
+            const PostingListView postings = segment.Find(query.plus_words[i]);
+            if (!postings.empty()) {
+                cursors.push_back({PostingCursor(postings), inverse_document_freqs[i], postings.GetMaxTermFreq() * inverse_document_freqs[i]});
+            }
         }
-        for (const auto [document_id, _] : word_to_document_freqs_.at(word)) {
-            document_to_relevance.erase(document_id);
+        std::sort(cursors.begin(), cursors.end(), [](const TermCursor& lhs, const TermCursor& rhs) {
+            return lhs.max_relevance < rhs.max_relevance;
+        });
+        max_relevance_prefix.resize(cursors.size());
+        double max_relevance_sum = 0.0;
+        for (size_t i = 0; i < cursors.size(); ++i) {
+            max_relevance_sum += cursors[i].max_relevance;
+            max_relevance_prefix[i] = max_relevance_sum;
         }
-    }
 
-    std::vector<Document> matched_documents;
-    for (const auto [document_id, relevance] : document_to_relevance.BuildOrdinaryMap()) {
-        matched_documents.push_back({document_id, relevance, documents_.at(document_id).rating});
-    }
-    return matched_documents;
-}
\ No newline at end of file
+        size_t first_essential = 0;
+        while (true) {
+            while (first_essential < cursors.size() && !top_documents.CanEnter(max_relevance_prefix[first_essential])) {
+                ++first_essential;
+            }
+            int document_index = std::numeric_limits<int>::max();
+            for (size_t i = first_essential; i < cursors.size(); ++i) {
+                if (!cursors[i].cursor.IsEnd()) {
+                    document_index = std::min(document_index, cursors[i].cursor.GetDocumentIndex());
+                }
+            }
+            if (document_index == std::numeric_limits<int>::max()) {
+                break;
+            }
+
+            const DocumentData* document_data = excluded.IsExcluded(document_index) ? nullptr : FilterDocument(document_predicate, document_index);
+            if (!document_data) {
+                for (size_t i = first_essential; i < cursors.size(); ++i) {
+                    auto& cursor = cursors[i].cursor;
+                    if (!cursor.IsEnd() && cursor.GetDocumentIndex() == document_index) {
+                        cursor.Next();
+                    }
+                }
+                continue;
+            }
+            double relevance = 0.0;
+            for (size_t i = first_essential; i < cursors.size(); ++i) {
+                auto& cursor = cursors[i].cursor;
+                if (!cursor.IsEnd() && cursor.GetDocumentIndex() == document_index) {
+                    relevance += cursor.GetTermCount() * document_data->inv_word_count * cursors[i].inverse_document_freq;
+                    cursor.Next();
+                }
+            }
+
+            bool can_enter = true;
+            for (size_t i = first_essential; i-- > 0;) {
+                if (!top_documents.CanEnter(relevance + max_relevance_prefix[i])) {
+                    can_enter = false;
+                    break;
+                }
+                auto& cursor = cursors[i].cursor;
+                cursor.NextGeq(document_index);
+                if (!cursor.IsEnd() && cursor.GetDocumentIndex() == document_index) {
+                    relevance += cursor.GetTermCount() * document_data->inv_word_count * cursors[i].inverse_document_freq;
+                }
+            }
+            if (can_enter) {
+                top_documents.Add({document_data->id, relevance, document_data->rating});
+            }
+        }
+    });
+    return top_documents;
+}
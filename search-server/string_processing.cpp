@@ -1,24 +1,120 @@
 #include "string_processing.h"
 
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using std::literals::string_literals::operator""s;
 
+namespace {
+
+#if defined(__GNUC__) && (defined(__AVX2__) || defined(__SSE2__))
+
+#if defined(__AVX2__)
+const size_t CHUNK_SIZE = 32;
+
+void ScanChunk(const char* data, uint64_t& spaces, uint64_t& controls) {
+    const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    const __m256i control_limit = _mm256_set1_epi8(' ' - 1);
+    spaces = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' '))));
+    controls = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(bytes, control_limit), control_limit)));
+}
+#else
+const size_t CHUNK_SIZE = 16;
+
+void ScanChunk(const char* data, uint64_t& spaces, uint64_t& controls) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    const __m128i control_limit = _mm_set1_epi8(' ' - 1);
+    spaces = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '))));
+    controls = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(bytes, control_limit), control_limit)));
+}
+#endif
+
+const uint64_t CHUNK_MASK = (uint64_t{1} << CHUNK_SIZE) - 1;
+
+#endif
+
+bool IsControl(char c) {
+    return static_cast<unsigned char>(c) < ' ';
+}
+
+bool Tokenize(std::string_view str, std::vector<std::string_view>& words) {
+    words.clear();
+    const char* data = str.data();
+    const size_t size = str.size();
+    bool is_valid = true;
+    size_t word_begin = str.npos;
+    size_t pos = 0;
+#if defined(__GNUC__) && (defined(__AVX2__) || defined(__SSE2__))
+    uint64_t previous_space = 1;
+    for (; pos + CHUNK_SIZE <= size; pos += CHUNK_SIZE) {
+        uint64_t spaces;
+        uint64_t controls;
+        ScanChunk(data + pos, spaces, controls);
+        is_valid = is_valid && controls == 0;
+        uint64_t boundaries = (spaces ^ ((spaces << 1) | previous_space)) & CHUNK_MASK;
+        previous_space = spaces >> (CHUNK_SIZE - 1);
+        while (boundaries != 0) {
+            const size_t boundary = pos + __builtin_ctzll(boundaries);
+            boundaries &= boundaries - 1;
+            if (word_begin == str.npos) {
+                word_begin = boundary;
+            } else {
+                words.emplace_back(data + word_begin, boundary - word_begin);
+                word_begin = str.npos;
+            }
+        }
+    }
+#endif
+    for (; pos < size; ++pos) {
+        const char c = data[pos];
+        is_valid = is_valid && !IsControl(c);
+        if (c == ' ') {
+            if (word_begin != str.npos) {
+                words.emplace_back(data + word_begin, pos - word_begin);
+                word_begin = str.npos;
+            }
+        } else if (word_begin == str.npos) {
+            word_begin = pos;
+        }
+    }
+    if (word_begin != str.npos) {
+        words.emplace_back(data + word_begin, size - word_begin);
+    }
+    return is_valid;
+}
+
+}
 
 std::vector<std::string_view> SplitIntoWords(std::string_view str) {
     std::vector<std::string_view> result;
-    str.remove_prefix(std::min(str.find_first_not_of(" "), str.size()));
-    
-    while (str.size() != 0) {
-        auto space = str.find(" ");
-        result.push_back(space == str.npos ? str : str.substr(0, space));
-        str.remove_prefix(std::min(space, str.size()));
-        str.remove_prefix(std::min((str.find_first_not_of(" ")), str.size()));
-    }
+    Tokenize(str, result);
     return result;
 }
 
+void SplitIntoWords(std::string_view str, std::vector<std::string_view>& words) {
+    Tokenize(str, words);
+}
+
+bool SplitIntoValidWords(std::string_view str, std::vector<std::string_view>& words) {
+    return Tokenize(str, words);
+}
 
 bool IsValidWord(const std::string_view word) {
-    return std::none_of(word.begin(), word.end(), [](char c) {
-        return c >= '\0' && c < ' ';
-    });
+    size_t pos = 0;
+#if defined(__GNUC__) && (defined(__AVX2__) || defined(__SSE2__))
+    for (; pos + CHUNK_SIZE <= word.size(); pos += CHUNK_SIZE) {
+        uint64_t spaces;
+        uint64_t controls;
+        ScanChunk(word.data() + pos, spaces, controls);
+        if (controls != 0) {
+            return false;
+        }
+    }
+#endif
+    return std::none_of(word.begin() + pos, word.end(), IsControl);
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 #include <stdexcept>
@@ -10,6 +11,10 @@ using std::literals::string_literals::operator""s;
 
 std::vector<std::string_view> SplitIntoWords(const std::string_view str);
 
+void SplitIntoWords(const std::string_view str, std::vector<std::string_view>& words);
+
+bool SplitIntoValidWords(const std::string_view str, std::vector<std::string_view>& words);
+
 bool IsValidWord(const std::string_view word);
 
 template <typename StringContainer>
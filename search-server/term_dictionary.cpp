@@ -0,0 +1,96 @@
+#include "term_dictionary.h"
+
+TermDictionary::TermDictionary(const TermDictionary& other)
+    : words_(other.words_)
+    , free_terms_(other.free_terms_)
+    , released_terms_(other.released_terms_) {
+    word_to_term_.reserve(other.word_to_term_.size());
+    for (const auto& [word, term] : other.word_to_term_) {
+        word_to_term_.emplace(words_[term], term);
+    }
+}
+
+TermDictionary& TermDictionary::operator=(const TermDictionary& other) {
+    if (this != &other) {
+        TermDictionary copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+TermId TermDictionary::Intern(std::string_view word) {
+    if (const auto it = word_to_term_.find(word); it != word_to_term_.end()) {
+        return it->second;
+    }
+    TermId term;
+    if (free_terms_.empty()) {
+        term = static_cast<TermId>(words_.size());
+        words_.emplace_back(word);
+    } else {
+        term = free_terms_.back();
+        free_terms_.pop_back();
+        words_[term].assign(word);
+    }
+    word_to_term_.emplace(words_[term], term);
+    return term;
+}
+
+TermId TermDictionary::Find(std::string_view word) const {
+    const auto it = word_to_term_.find(word);
+    return it == word_to_term_.end() ? NO_TERM : it->second;
+}
+
+std::string_view TermDictionary::GetWord(TermId term) const {
+    return words_[term];
+}
+
+void TermDictionary::Release(TermId term) {
+    word_to_term_.erase(words_[term]);
+    words_[term].clear();
+    released_terms_.push_back(term);
+}
+
+size_t TermDictionary::size() const {
+    return word_to_term_.size();
+}
+
+size_t TermDictionary::GetIdBound() const {
+    return words_.size();
+}
+
+void TermDictionary::Save(IndexFileWriter& writer) const {
+    writer.WriteValue<uint64_t>(words_.size());
+    for (const std::string& word : words_) {
+        writer.WriteString(word);
+    }
+    writer.WriteValue<uint64_t>(free_terms_.size());
+    writer.WriteArray(free_terms_.data(), free_terms_.size());
+}
+
+TermDictionary TermDictionary::Load(IndexFileReader& reader) {
+    TermDictionary dictionary;
+    const uint64_t word_count = reader.ReadCount(sizeof(uint64_t));
+    dictionary.word_to_term_.reserve(word_count);
+    for (uint64_t term = 0; term < word_count; ++term) {
+        const std::string& word = dictionary.words_.emplace_back(reader.ReadString());
+        if (!word.empty() && !dictionary.word_to_term_.emplace(word, static_cast<TermId>(term)).second) {
+            throw std::runtime_error("Некорректный формат индекса"s);
+        }
+    }
+    const uint64_t free_count = reader.ReadValue<uint64_t>();
+    const TermId* free_terms = reader.ReadArray<TermId>(free_count);
+    dictionary.free_terms_.assign(free_terms, free_terms + free_count);
+    std::vector<bool> is_free(word_count);
+    for (const TermId term : dictionary.free_terms_) {
+        if (term >= word_count || !dictionary.words_[term].empty() || is_free[term]) {
+            throw std::runtime_error("Некорректный формат индекса"s);
+        }
+        is_free[term] = true;
+    }
+    for (TermId term = 0; term < word_count; ++term) {
+        if (dictionary.words_[term].empty() && !is_free[term]) {
+            dictionary.released_terms_.push_back(term);
+        }
+    }
+    return dictionary;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "index_file.h"
+
+using TermId = uint32_t;
+
+class TermDictionary {
+public:
+    static constexpr TermId NO_TERM = std::numeric_limits<TermId>::max();
+
+    TermDictionary() = default;
+
+    TermDictionary(const TermDictionary& other);
+
+    TermDictionary(TermDictionary&& other) = default;
+
+    TermDictionary& operator=(const TermDictionary& other);
+
+    TermDictionary& operator=(TermDictionary&& other) = default;
+
+    TermId Intern(std::string_view word);
+
+    TermId Find(std::string_view word) const;
+
+    std::string_view GetWord(TermId term) const;
+
+    void Release(TermId term);
+
+    template <typename TermPredicate>
+    void RecycleReleased(TermPredicate is_term_referenced);
+
+    size_t size() const;
+
+    size_t GetIdBound() const;
+
+    void Save(IndexFileWriter& writer) const;
+
+    static TermDictionary Load(IndexFileReader& reader);
+
+private:
+    std::deque<std::string> words_;
+    std::unordered_map<std::string_view, TermId> word_to_term_;
+    std::vector<TermId> free_terms_;
+    std::vector<TermId> released_terms_;
+};
+
+// Освобождённый идентификатор не выдаётся повторно, пока на него ссылаются сегменты индекса
+template <typename TermPredicate>
+void TermDictionary::RecycleReleased(TermPredicate is_term_referenced) {
+    auto last = released_terms_.begin();
+    for (const TermId term : released_terms_) {
+        if (is_term_referenced(term)) {
+            *last++ = term;
+        } else {
+            free_terms_.push_back(term);
+        }
+    }
+    released_terms_.erase(last, released_terms_.end());
+}
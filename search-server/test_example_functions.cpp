@@ -12,6 +12,15 @@ void AssertImpl(bool value, const std::string& expr_str, const std::string& file
     }
 }
 
+void AssertSameDocuments(const std::vector<Document>& lhs, const std::vector<Document>& rhs) {
+    ASSERT_EQUAL(lhs.size(), rhs.size());
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        ASSERT_EQUAL(lhs[i].id, rhs[i].id);
+        ASSERT_EQUAL(lhs[i].rating, rhs[i].rating);
+        ASSERT(std::abs(lhs[i].relevance - rhs[i].relevance) < EPSILON);
+    }
+}
+
 void TestAddAndFindDocument() {
     SearchServer server("и в на"s);
     server.AddDocument(0, "белый кот и модный ошейник"s,        DocumentStatus::ACTUAL, {8, -2});
@@ -110,6 +119,1274 @@ void TestCalculatingRelevance() {
     ASSERT(std::abs(v[1].relevance - 0.173287) < EPSILON);
 }
 
+void TestAddAndRemoveInAnyOrder() {
+    SearchServer server("и в на"s);
+    server.AddDocument(5, "белый кот и модный ошейник"s,       DocumentStatus::ACTUAL, {8, -2});
+    server.AddDocument(1, "пушистый кот пушистый хвост"s,      DocumentStatus::ACTUAL, {7, 2, 6});
+    server.AddDocument(3, "ухоженный кот выразительные глаза"s,DocumentStatus::ACTUAL, {5, -12, 2, 1});
+    ASSERT_EQUAL(server.FindTopDocuments("кот"s).size(), 3);
+    server.RemoveDocument(3);
+    std::vector<Document> v = server.FindTopDocuments("кот"s);
+    ASSERT_EQUAL(v.size(), 2);
+    ASSERT_EQUAL(v[0].id, 1);
+    ASSERT_EQUAL(v[1].id, 5);
+    ASSERT(server.FindTopDocuments("ухоженный"s).empty());
+    server.RemoveDocument(std::execution::par, 1);
+    v = server.FindTopDocuments("кот"s);
+    ASSERT_EQUAL(v.size(), 1);
+    ASSERT_EQUAL(v[0].id, 5);
+}
+
+void TestTermReuseAfterRemove() {
+    SearchServer server("и в на"s);
+    server.AddDocument(0, "белый кот и модный ошейник"s,       DocumentStatus::ACTUAL, {8, -2});
+    server.AddDocument(1, "пушистый кот пушистый хвост"s,      DocumentStatus::ACTUAL, {7, 2, 6});
+    server.RemoveDocument(0);
+    server.AddDocument(2, "ухоженный пёс выразительные глаза"s,DocumentStatus::ACTUAL, {5, -12, 2, 1});
+    ASSERT(server.FindTopDocuments("белый ошейник"s).empty());
+    ASSERT_EQUAL(server.FindTopDocuments("пёс"s).size(), 1);
+    const auto frequencies = server.GetWordFrequencies(1);
+    ASSERT_EQUAL(frequencies.size(), 3);
+    ASSERT(std::abs(frequencies.at("пушистый"s) - 0.5) < EPSILON);
+    const auto [words, status] = server.MatchDocument("хвост пушистый -белый"s, 1);
+    ASSERT_EQUAL(words.size(), 2);
+    ASSERT_EQUAL(words[0], "пушистый"s);
+    ASSERT_EQUAL(words[1], "хвост"s);
+}
+
+void TestReleasedTermRecycling() {
+    TermDictionary dictionary;
+    const TermId cat = dictionary.Intern("кот"s);
+    dictionary.Intern("пёс"s);
+    dictionary.Release(cat);
+    ASSERT_EQUAL(dictionary.Find("кот"s), TermDictionary::NO_TERM);
+    const TermId tail = dictionary.Intern("хвост"s);
+    ASSERT(tail != cat);
+    dictionary.RecycleReleased([cat](TermId term) { return term == cat; });
+    ASSERT(dictionary.Intern("ошейник"s) != cat);
+    dictionary.RecycleReleased([](TermId) { return false; });
+    ASSERT_EQUAL(dictionary.Intern("ошейник"s), 3u);
+    ASSERT_EQUAL(dictionary.Intern("глаза"s), cat);
+    ASSERT_EQUAL(dictionary.size(), 4u);
+}
+
+void TestTopDocumentsCount() {
+    SearchServer server("и в на"s);
+    for (int id = 0; id < 100; ++id) {
+        server.AddDocument(id, id % 3 == 0 ? "пушистый кот"s : "кот и модный ошейник"s, DocumentStatus::ACTUAL, {id % 7});
+    }
+    const std::vector<Document> seq = server.FindTopDocuments("пушистый кот"s, DocumentStatus::ACTUAL, 10);
+    const std::vector<Document> par = server.FindTopDocuments(std::execution::par, "пушистый кот"s, DocumentStatus::ACTUAL, 10);
+    ASSERT_EQUAL(seq.size(), 10);
+    ASSERT_EQUAL(par.size(), 10);
+    for (size_t i = 0; i < seq.size(); ++i) {
+        ASSERT_EQUAL(seq[i].id, par[i].id);
+        ASSERT_EQUAL(seq[i].id % 3, 0);
+        if (i > 0) {
+            ASSERT(seq[i - 1].rating >= seq[i].rating);
+        }
+    }
+    ASSERT_EQUAL(seq[0].rating, 6);
+    ASSERT(server.FindTopDocuments("кот"s, DocumentStatus::ACTUAL, 0).empty());
+    ASSERT_EQUAL(server.FindTopDocuments("кот"s).size(), MAX_RESULT_DOCUMENT_COUNT);
+}
+
+void TestRelevanceAccumulator() {
+    for (const size_t document_bound : {size_t{10}, MAX_DENSE_ACCUMULATOR_SIZE + 1}) {
+        RelevanceAccumulator& accumulator = RelevanceAccumulator::ForCurrentThread(document_bound);
+        accumulator.Exclude(3);
+        accumulator.Add(1, 0.5);
+        accumulator.Add(3, 1.0);
+        accumulator.Add(1, 0.25);
+        accumulator.Add(7, 2.0);
+        std::map<int, double> result;
+        accumulator.ForEach([&result](int document_index, double relevance) {
+            result[document_index] = relevance;
+        });
+        ASSERT_EQUAL(result.size(), 2);
+        ASSERT(std::abs(result.at(1) - 0.75) < EPSILON);
+        ASSERT(std::abs(result.at(7) - 2.0) < EPSILON);
+        ASSERT(accumulator.IsExcluded(3));
+    }
+    int count = 0;
+    RelevanceAccumulator::ForCurrentThread(10).ForEach([&count](int, double) { ++count; });
+    ASSERT_EQUAL(count, 0);
+}
+
+void TestPrunedSearchMatchesExhaustive() {
+    SearchServer server("и в на"s);
+    const std::vector<std::string> rare_words = {"пушистый"s, "ухоженный"s, "модный"s, "белый"s};
+    for (int id = 0; id < 300; ++id) {
+        std::string text = "кот"s;
+        for (int i = 0; i < id % 4; ++i) {
+            text += " хвост"s;
+        }
+        if (id % 13 == 0) {
+            text += " "s + rare_words[id % rare_words.size()];
+        }
+        if (id % 17 == 0) {
+            text += " ошейник"s;
+        }
+        server.AddDocument(id, text, id % 5 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL, {id % 11});
+    }
+    const auto predicate = [](int document_id, DocumentStatus status, int) {
+        return status == DocumentStatus::ACTUAL && document_id % 3 != 0;
+    };
+    for (const std::string& query : {"кот пушистый ухоженный"s, "кот модный -ошейник"s, "кот хвост белый"s}) {
+        const std::vector<Document> pruned = server.FindTopDocuments(query, predicate, 7);
+        const std::vector<Document> exhaustive = server.FindTopDocuments(std::execution::par, query, predicate, 7);
+        ASSERT_EQUAL(pruned.size(), exhaustive.size());
+        for (size_t i = 0; i < pruned.size(); ++i) {
+            ASSERT_EQUAL(pruned[i].id, exhaustive[i].id);
+            ASSERT(std::abs(pruned[i].relevance - exhaustive[i].relevance) < EPSILON);
+        }
+    }
+}
+
+void TestPostingListCompression() {
+    PostingList postings;
+    std::map<int, uint32_t> expected;
+    for (int i = 0; i < 1000; ++i) {
+        const int document_index = i * 3 + (i % 7) * (i % 5 == 0 ? 1000 : 0) / 1000;
+        const uint32_t term_count = 1 + (i % 11 == 0 ? 70000 : i % 3);
+        postings.Add(document_index, term_count, 0.1);
+        expected[document_index] += term_count;
+    }
+    for (int document_index = 0; document_index < 3000; document_index += 13) {
+        ASSERT_EQUAL(postings.Remove(document_index), expected.erase(document_index) > 0);
+    }
+    postings.Add(1, 5, 0.2);
+    expected[1] += 5;
+    ASSERT_EQUAL(postings.size(), expected.size());
+    ASSERT(std::abs(postings.GetMaxTermFreq() - 0.2) < EPSILON);
+    auto it = expected.begin();
+    for (const auto [document_index, term_count] : postings) {
+        ASSERT_EQUAL(document_index, it->first);
+        ASSERT_EQUAL(term_count, it->second);
+        ++it;
+    }
+    ASSERT(it == expected.end());
+    PostingCursor cursor(postings);
+    for (int target = 0; target < 3100; target += 97) {
+        cursor.NextGeq(target);
+        const auto lower = expected.lower_bound(target);
+        ASSERT_EQUAL(cursor.IsEnd(), lower == expected.end());
+        if (!cursor.IsEnd()) {
+            ASSERT_EQUAL(cursor.GetDocumentIndex(), lower->first);
+            ASSERT_EQUAL(postings.Contains(target), lower->first == target);
+        }
+    }
+}
+
+void TestSplitIntoWords() {
+    const std::string alphabet = "ab  кот\x01"s;
+    std::vector<std::string_view> words;
+    for (size_t length = 0; length < 200; ++length) {
+        std::string text;
+        for (size_t i = 0; i < length; ++i) {
+            text += alphabet[(i * 7 + length * 3 + i * i) % (alphabet.size() - (length % 3 == 0 ? 0 : 1))];
+        }
+        std::vector<std::string_view> expected;
+        bool expected_valid = true;
+        size_t word_begin = 0;
+        for (size_t i = 0; i <= text.size(); ++i) {
+            if (i == text.size() || text[i] == ' ') {
+                if (i > word_begin) {
+                    expected.push_back(std::string_view(text).substr(word_begin, i - word_begin));
+                }
+                word_begin = i + 1;
+            } else if (static_cast<unsigned char>(text[i]) < ' ') {
+                expected_valid = false;
+            }
+        }
+        ASSERT_EQUAL(SplitIntoValidWords(text, words), expected_valid);
+        ASSERT_EQUAL(IsValidWord(text), expected_valid);
+        ASSERT(words == expected);
+        ASSERT(SplitIntoWords(text) == expected);
+    }
+}
+
+void TestParallelSearchMatchesSequential() {
+    SearchServer server("и в на"s);
+    const std::vector<std::string> words = {"кот"s, "пёс"s, "хвост"s, "ошейник"s, "скворец"s, "модный"s, "белый"s};
+    for (int id = 0; id < 3 * MIN_PARALLEL_RANGE_SIZE; ++id) {
+        std::string text;
+        for (size_t i = 0; i < words.size(); ++i) {
+            if ((id + i * i) % (i + 2) == 0) {
+                text += words[i] + " "s;
+            }
+        }
+        server.AddDocument(id, text, DocumentStatus::ACTUAL, {id % 13});
+    }
+    for (const std::string& query : {"кот скворец"s, "пёс белый -модный"s, "хвост ошейник -кот"s}) {
+        const std::vector<Document> sequential = server.FindTopDocuments(query, DocumentStatus::ACTUAL, 20);
+        const std::vector<Document> parallel = server.FindTopDocuments(std::execution::par, query, DocumentStatus::ACTUAL, 20);
+        ASSERT_EQUAL(sequential.size(), parallel.size());
+        for (size_t i = 0; i < sequential.size(); ++i) {
+            ASSERT_EQUAL(sequential[i].id, parallel[i].id);
+        }
+    }
+}
+
+void TestConcurrentMap() {
+    ConcurrentMap<int, int> counters(7);
+    std::vector<int> keys(20000);
+    std::iota(keys.begin(), keys.end(), -10000);
+    std::for_each(std::execution::par, keys.begin(), keys.end(), [&counters](int key) {
+        counters[key % 997].ref_to_value += 1;
+        counters[key].ref_to_value += key;
+    });
+    for (int key = -10000; key < 10000; key += 2) {
+        counters.erase(key);
+    }
+    std::map<int, int> expected;
+    for (int key : keys) {
+        expected[key % 997] += 1;
+        expected[key] += key;
+    }
+    for (int key = -10000; key < 10000; key += 2) {
+        expected.erase(key);
+    }
+    ASSERT_EQUAL(counters.size(), expected.size());
+    ASSERT(counters.BuildOrdinaryMap() == expected);
+    const auto sorted = counters.BuildSortedVector(std::execution::par);
+    ASSERT((std::vector<std::pair<int, int>>(expected.begin(), expected.end()) == sorted));
+    auto unsorted = counters.BuildVector(std::execution::par);
+    std::sort(unsorted.begin(), unsorted.end());
+    ASSERT(unsorted == sorted);
+
+    ConcurrentMap<std::string, int> words(3);
+    for (const std::string& word : {"кот"s, "пёс"s, "кот"s, "хвост"s, "кот"s}) {
+        ++words[word].ref_to_value;
+    }
+    words.erase("хвост"s);
+    words.erase("скворец"s);
+    int total = 0;
+    words.ForEach([&total](const std::string&, int count) {
+        total += count;
+    });
+    ASSERT_EQUAL(total, 4);
+    ASSERT((words.BuildOrdinaryMap() == std::map<std::string, int>{{"кот"s, 3}, {"пёс"s, 1}}));
+
+    struct DocumentKey {
+        explicit DocumentKey(int id) : id(id) {
+        }
+        bool operator==(const DocumentKey& other) const {
+            return id == other.id;
+        }
+        bool operator<(const DocumentKey& other) const {
+            return id < other.id;
+        }
+        int id;
+    };
+    struct DocumentKeyHash {
+        size_t operator()(const DocumentKey& key) const {
+            return std::hash<int>{}(key.id);
+        }
+    };
+    ConcurrentMap<DocumentKey, std::vector<int>, DocumentKeyHash> documents(2);
+    for (int id = 0; id < 100; ++id) {
+        documents[DocumentKey(id % 10)].ref_to_value.push_back(id);
+    }
+    documents.erase(DocumentKey(3));
+    const auto sorted_documents = documents.BuildSortedVector(std::execution::par);
+    ASSERT_EQUAL(sorted_documents.size(), 9u);
+    ASSERT_EQUAL(sorted_documents[3].first.id, 4);
+    ASSERT((sorted_documents[3].second == std::vector<int>{4, 14, 24, 34, 44, 54, 64, 74, 84, 94}));
+}
+
+void TestProcessQueries() {
+    SearchServer server("и в на"s);
+    const std::vector<std::string> words = {"кот"s, "пёс"s, "хвост"s, "ошейник"s, "скворец"s};
+    for (int id = 0; id < 3 * MIN_PARALLEL_RANGE_SIZE; ++id) {
+        std::string text = "кот "s;
+        for (size_t i = 1; i < words.size(); ++i) {
+            if ((id + i) % (i + 1) == 0) {
+                text += words[i] + " "s;
+            }
+        }
+        server.AddDocument(id, text, DocumentStatus::ACTUAL, {id % 7});
+    }
+    const std::vector<std::string> queries = {
+        "кот пёс хвост"s, "скворец -пёс"s, "хвост пёс кот"s, "кот пёс хвост"s, "ошейник"s, "белый"s, "кот -скворец хвост"s,
+    };
+    ASSERT(server.GetQueryCost(server.ParseQuery(queries[0])) >= MIN_SPLIT_QUERY_COST);
+    for (size_t thread_count : {1, 4}) {
+        BatchExecutor executor(thread_count);
+        const auto results = ProcessQueries(executor, server, queries);
+        const auto joined = ProcessQueriesJoined(executor, server, queries);
+        ASSERT_EQUAL(results.size(), queries.size());
+        ASSERT_EQUAL(joined.GetQueryCount(), queries.size());
+        std::vector<int> flat_ids;
+        for (size_t i = 0; i < queries.size(); ++i) {
+            const auto expected = server.FindTopDocuments(queries[i]);
+            ASSERT_EQUAL(results[i].size(), expected.size());
+            ASSERT_EQUAL(joined.GetQueryResults(i).size(), expected.size());
+            auto joined_it = joined.GetQueryResults(i).begin();
+            for (size_t j = 0; j < expected.size(); ++j) {
+                ASSERT_EQUAL(results[i][j].id, expected[j].id);
+                ASSERT_EQUAL((joined_it++)->id, expected[j].id);
+                flat_ids.push_back(expected[j].id);
+            }
+        }
+        ASSERT_EQUAL(joined.size(), flat_ids.size());
+        ASSERT(std::equal(joined.begin(), joined.end(), flat_ids.begin(), [](const Document& document, int id) {
+            return document.id == id;
+        }));
+        try {
+            ProcessQueries(executor, server, {"кот"s, "кот --пёс"s});
+            ASSERT_HINT(false, "invalid query must throw"s);
+        } catch (const std::invalid_argument&) {
+        }
+        ASSERT_EQUAL(ProcessQueries(executor, server, {"ошейник"s}).size(), 1);
+
+        std::atomic<int> failed_count = 0;
+        std::vector<std::thread> callers;
+        for (int caller = 0; caller < 4; ++caller) {
+            callers.emplace_back([&, caller] {
+                for (int round = 0; round < 5; ++round) {
+                    try {
+                        const auto caller_results = ProcessQueries(executor, server, caller % 2 == 0 ? queries : std::vector<std::string>{"кот"s, "кот --пёс"s});
+                        ASSERT(caller % 2 == 0);
+                        ASSERT_EQUAL(caller_results[4].size(), results[4].size());
+                    } catch (const std::invalid_argument&) {
+                        ASSERT(caller % 2 == 1);
+                        ++failed_count;
+                    }
+                }
+            });
+        }
+        for (auto& caller : callers) {
+            caller.join();
+        }
+        ASSERT_EQUAL(failed_count, 10);
+    }
+}
+
+void TestQueryCache() {
+    SearchServer server("и в на"s);
+    server.AddDocument(0, "белый кот и модный ошейник"s, DocumentStatus::ACTUAL, {8, -2});
+    server.AddDocument(1, "пушистый кот пушистый хвост"s, DocumentStatus::ACTUAL, {7, 2, 6});
+    server.AddDocument(2, "ухоженный пёс выразительные глаза"s, DocumentStatus::BANNED, {5, -12, 2, 1});
+    QueryCache cache(server, 2, 1);
+
+    ASSERT_EQUAL(cache.FindTopDocuments("пушистый кот"s).size(), 2);
+    ASSERT_EQUAL(cache.FindTopDocuments("кот пушистый кот и скворец"s).size(), 2);
+    ASSERT_EQUAL(cache.GetHitCount(), 1);
+    ASSERT_EQUAL(cache.GetMissCount(), 1);
+
+    ASSERT_EQUAL(cache.FindTopDocuments("пушистый кот"s, DocumentStatus::ACTUAL, 1).size(), 1);
+    ASSERT_EQUAL(cache.FindTopDocuments("пёс"s, DocumentStatus::BANNED).size(), 1);
+    ASSERT_EQUAL(cache.GetMissCount(), 3);
+    ASSERT_EQUAL(cache.size(), 2);
+    ASSERT_EQUAL(cache.FindTopDocuments("пушистый кот"s).size(), 2);
+    ASSERT_EQUAL(cache.GetMissCount(), 4);
+
+    const auto even = [](int document_id, DocumentStatus, int) {
+        return document_id % 2 == 0;
+    };
+    ASSERT_EQUAL(cache.FindTopDocuments("кот"s, 1, even).size(), 1);
+    ASSERT_EQUAL(cache.FindTopDocuments("кот"s, 1, even).size(), 1);
+    ASSERT_EQUAL(cache.GetHitCount(), 2);
+
+    server.AddDocument(3, "кот скворец"s, DocumentStatus::ACTUAL, {1});
+    ASSERT_EQUAL(cache.FindTopDocuments("кот"s, 1, even).size(), 1);
+    ASSERT_EQUAL(cache.FindTopDocuments("кот скворец"s).front().id, 3);
+    ASSERT_EQUAL(cache.GetHitCount(), 2);
+    server.RemoveDocument(3);
+    ASSERT_EQUAL(cache.FindTopDocuments("кот скворец"s).size(), 2);
+    ASSERT_EQUAL(cache.GetHitCount(), 2);
+    ASSERT_EQUAL(cache.GetMissCount(), 8);
+}
+
+void TestConcurrentSearchServer() {
+    ConcurrentSearchServer server("и в на"s);
+    server.AddDocument(1, "пушистый кот пушистый хвост"s, DocumentStatus::ACTUAL, {7, 2, 6});
+    {
+        const auto snapshot = server.GetSnapshot();
+        ASSERT_EQUAL(snapshot->GetDocumentCount(), 0);
+        server.Publish();
+        ASSERT_EQUAL(snapshot->GetDocumentCount(), 0);
+    }
+    ASSERT_EQUAL(server.GetSnapshot()->FindTopDocuments("кот"s).size(), 1);
+
+    std::atomic<bool> done = false;
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 2; ++i) {
+        readers.emplace_back([&server, &done] {
+            int last_count = 0;
+            while (!done) {
+                const auto snapshot = server.GetSnapshot();
+                const int count = snapshot->GetDocumentCount();
+                ASSERT(count >= last_count);
+                ASSERT_EQUAL(snapshot->FindTopDocuments("кот"s, DocumentStatus::ACTUAL, 1000).size(), static_cast<size_t>(count));
+                last_count = count;
+            }
+        });
+    }
+    for (int id = 2; id <= 200; ++id) {
+        server.AddDocument(id, "кот номер "s + std::to_string(id), DocumentStatus::ACTUAL, {id});
+        if (id % 10 == 0) {
+            server.Publish();
+        }
+    }
+    server.RemoveDocument(1);
+    server.AddDocument(201, "кот скворец"s, DocumentStatus::ACTUAL, {1});
+    server.Publish();
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    const auto snapshot = server.GetSnapshot();
+    ASSERT_EQUAL(snapshot->GetDocumentCount(), 200);
+    ASSERT(snapshot->FindTopDocuments("хвост"s).empty());
+    server.AddDocument(202, "кот"s, DocumentStatus::ACTUAL, {1});
+    ASSERT_EQUAL(snapshot->GetDocumentCount(), 200);
+}
+
+void TestConcurrentSearchServerTrimsLog() {
+    ConcurrentSearchServer server("и в на"s);
+    server.AddDocument(1, "кот"s, DocumentStatus::ACTUAL, {1});
+    server.Publish();
+    std::optional<ConcurrentSearchServer::Snapshot> pinned = server.GetSnapshot();
+    int id = 2;
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < 3; ++i, ++id) {
+            server.AddDocument(id, "кот номер "s + std::to_string(id), DocumentStatus::ACTUAL, {id});
+        }
+        server.Publish();
+        ASSERT((*pinned)->GetDocumentCount() == 1);
+    }
+    ASSERT(server.GetOperationLogSize() <= 3u);
+    pinned.reset();
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 3; ++i, ++id) {
+            server.AddDocument(id, "кот номер "s + std::to_string(id), DocumentStatus::ACTUAL, {id});
+        }
+        server.Publish();
+        ASSERT(server.GetOperationLogSize() <= 3u);
+        ASSERT_EQUAL(server.GetSnapshot()->GetDocumentCount(), id - 1);
+    }
+    server.RemoveDocument(1);
+    server.Publish();
+    server.Publish();
+    ASSERT_EQUAL(server.GetSnapshot()->GetDocumentCount(), id - 2);
+    ASSERT_EQUAL(server.GetSnapshot()->FindTopDocuments("кот"s, DocumentStatus::ACTUAL, 1000).size(), static_cast<size_t>(id - 2));
+}
+
+void TestSegmentedIndex() {
+    SearchServer server("и в на"s);
+    SearchServer reference("и в на"s);
+    const std::vector<std::string> words = {"кот"s, "пёс"s, "хвост"s, "ошейник"s, "скворец"s, "модный"s};
+    const int document_count = 2 * SEGMENT_SEAL_SIZE + 100;
+    for (int id = 0; id < document_count; ++id) {
+        std::string text;
+        for (size_t i = 0; i < words.size(); ++i) {
+            if ((id * 7 + i * 3) % (i + 2) == 0) {
+                text += words[i] + " "s;
+            }
+        }
+        text += "номер"s + std::to_string(id % 50);
+        server.AddDocument(id, text, DocumentStatus::ACTUAL, {id % 11});
+        if (id % 3 != 0) {
+            reference.AddDocument(id, text, DocumentStatus::ACTUAL, {id % 11});
+        }
+    }
+    ASSERT_EQUAL(server.GetSegmentCount(), 3);
+    for (int id = 0; id < document_count; id += 3) {
+        server.RemoveDocument(id);
+    }
+    const auto check = [&] {
+        ASSERT_EQUAL(server.GetDocumentCount(), reference.GetDocumentCount());
+        for (const std::string& query : {"кот скворец"s, "пёс модный -хвост"s, "ошейник номер7"s, "номер3 номер9"s}) {
+            const auto found = server.FindTopDocuments(query);
+            const auto expected = reference.FindTopDocuments(query);
+            ASSERT_EQUAL(found.size(), expected.size());
+            for (size_t i = 0; i < found.size(); ++i) {
+                ASSERT_EQUAL(found[i].id, expected[i].id);
+                ASSERT(std::abs(found[i].relevance - expected[i].relevance) < EPSILON);
+            }
+        }
+    };
+    check();
+    server.MergeSegments();
+    ASSERT_EQUAL(server.GetSegmentCount(), 1);
+    check();
+}
+
+void TestDocumentIndexCompaction() {
+    const std::vector<std::string> words = {"кот"s, "пёс"s, "хвост"s, "ошейник"s, "скворец"s, "модный"s};
+    const int document_count = 300;
+    const auto make_text = [&words](int id, int round) {
+        std::string text;
+        for (size_t i = 0; i < words.size(); ++i) {
+            if ((id * 7 + round + i) % (i + 2) == 0) {
+                text += words[i] + " "s;
+            }
+        }
+        return text + "номер"s + std::to_string((id + round) % 40);
+    };
+    const auto make_status = [](int id) {
+        return id % 7 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+    };
+    SearchServer server("и в на"s);
+    const int round_count = 3 * MIN_COMPACTION_REMOVED_COUNT / document_count;
+    for (int round = 0; round < round_count; ++round) {
+        for (int id = 0; id < document_count; ++id) {
+            server.AddDocument(id, make_text(id, round), make_status(id), {(id + round) % 13});
+        }
+        ASSERT(server.SplitDocumentRanges().back().second <= MIN_COMPACTION_REMOVED_COUNT + 3 * document_count);
+        if (round + 1 == round_count) {
+            break;
+        }
+        if (round % 2 == 0) {
+            for (int id = 0; id < document_count; ++id) {
+                server.RemoveDocument(id);
+            }
+        } else {
+            std::vector<int> ids(document_count);
+            std::iota(ids.begin(), ids.end(), 0);
+            server.RemoveDocuments(ids);
+        }
+    }
+    ASSERT(server.SplitDocumentRanges().back().second <= MIN_COMPACTION_REMOVED_COUNT + 3 * document_count);
+
+    SearchServer reference("и в на"s);
+    for (int id = 0; id < document_count; ++id) {
+        reference.AddDocument(id, make_text(id, round_count - 1), make_status(id), {(id + round_count - 1) % 13});
+    }
+    ASSERT_EQUAL(server.GetDocumentCount(), reference.GetDocumentCount());
+    for (const std::string& query : {"кот скворец"s, "пёс модный -хвост"s, "ошейник номер7"s}) {
+        for (const DocumentStatus status : {DocumentStatus::ACTUAL, DocumentStatus::BANNED}) {
+            AssertSameDocuments(server.FindTopDocuments(query, status), reference.FindTopDocuments(query, status));
+        }
+        const auto high_rating = [](int, DocumentStatus, int rating) {
+            return rating > 8;
+        };
+        AssertSameDocuments(server.FindTopDocuments(query, high_rating), reference.FindTopDocuments(query, high_rating));
+    }
+    for (int id = 0; id < document_count; id += 17) {
+        ASSERT(server.GetWordFrequencies(id) == reference.GetWordFrequencies(id));
+        ASSERT(server.MatchDocument("кот модный"s, id) == reference.MatchDocument("кот модный"s, id));
+    }
+
+    const std::string path = "search_server_compaction_test.idx"s;
+    server.Save(path);
+    AssertSameDocuments(SearchServer::Load(path).FindTopDocuments("кот скворец"s), reference.FindTopDocuments("кот скворец"s));
+    std::remove(path.c_str());
+}
+
+void TestAddDocuments() {
+    const std::vector<std::string> words = {"кот"s, "пёс"s, "хвост"s, "ошейник"s, "скворец"s, "модный"s};
+    std::vector<std::string> texts;
+    for (int id = 0; id < 2 * SEGMENT_SEAL_SIZE + 500; ++id) {
+        std::string text;
+        for (size_t i = 0; i < words.size(); ++i) {
+            if ((id * 5 + i) % (i + 2) == 0) {
+                text += words[i] + " "s;
+            }
+        }
+        texts.push_back(text + "номер"s + std::to_string(id % 30));
+    }
+    SearchServer reference("и в на"s);
+    for (int id = 0; id < static_cast<int>(texts.size()); ++id) {
+        reference.AddDocument(id, texts[id], DocumentStatus::ACTUAL, {id % 9, 1});
+    }
+    const auto check = [&reference](const SearchServer& server) {
+        ASSERT_EQUAL(server.GetDocumentCount(), reference.GetDocumentCount());
+        for (const std::string& query : {"кот скворец"s, "пёс модный -хвост"s, "ошейник номер7"s}) {
+            const auto found = server.FindTopDocuments(query);
+            const auto expected = reference.FindTopDocuments(query);
+            ASSERT_EQUAL(found.size(), expected.size());
+            for (size_t i = 0; i < found.size(); ++i) {
+                ASSERT_EQUAL(found[i].id, expected[i].id);
+                ASSERT(std::abs(found[i].relevance - expected[i].relevance) < EPSILON);
+            }
+        }
+        for (int id = 0; id < 100; ++id) {
+            ASSERT(server.GetWordFrequencies(id) == reference.GetWordFrequencies(id));
+        }
+    };
+
+    SearchServer sequential("и в на"s);
+    SearchServer parallel("и в на"s);
+    for (int id = 0; id < 100; ++id) {
+        sequential.AddDocument(id, texts[id], DocumentStatus::ACTUAL, {id % 9, 1});
+        parallel.AddDocument(id, texts[id], DocumentStatus::ACTUAL, {id % 9, 1});
+    }
+    std::vector<DocumentInput> batch;
+    for (int id = 100; id < static_cast<int>(texts.size()); ++id) {
+        batch.push_back({id, texts[id], DocumentStatus::ACTUAL, {id % 9, 1}});
+    }
+    sequential.AddDocuments(std::execution::seq, batch);
+    parallel.AddDocuments(std::execution::par, batch);
+    ASSERT_EQUAL(parallel.GetSegmentCount(), 3);
+    check(sequential);
+    check(parallel);
+
+    const std::vector<DocumentInput> invalid_batch = {{-2, "кот", DocumentStatus::ACTUAL, {1}}};
+    const std::vector<DocumentInput> duplicate_batch = {{100000, "кот", DocumentStatus::ACTUAL, {1}}, {100000, "пёс", DocumentStatus::ACTUAL, {1}}};
+    for (const auto* bad_batch : {&invalid_batch, &duplicate_batch}) {
+        try {
+            parallel.AddDocuments(std::execution::par, *bad_batch);
+            ASSERT_HINT(false, "invalid batch must throw"s);
+        } catch (const std::invalid_argument&) {
+        }
+        check(parallel);
+    }
+}
+
+void TestSaveLoad() {
+    const std::vector<std::string> words = {"кот"s, "пёс"s, "хвост"s, "ошейник"s, "скворец"s, "модный"s};
+    SearchServer server("и в на"s);
+    for (int id = 0; id < SEGMENT_SEAL_SIZE + 700; ++id) {
+        std::string text = "и"s;
+        for (size_t i = 0; i < words.size(); ++i) {
+            if ((id * 7 + i) % (i + 2) == 0) {
+                text += " "s + words[i];
+            }
+        }
+        const DocumentStatus status = id % 11 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+        server.AddDocument(id, text + " номер"s + std::to_string(id % 40), status, {id % 13, -2});
+    }
+    for (int id = 0; id < SEGMENT_SEAL_SIZE + 700; id += 3) {
+        server.RemoveDocument(id);
+    }
+    const std::string path = "search_server_test.idx"s;
+    server.Save(path);
+    SearchServer loaded = SearchServer::Load(path);
+
+    const auto check = [](const SearchServer& lhs, const SearchServer& rhs) {
+        ASSERT_EQUAL(lhs.GetDocumentCount(), rhs.GetDocumentCount());
+        ASSERT_EQUAL(lhs.GetEpoch(), rhs.GetEpoch());
+        ASSERT((std::vector<int>(lhs.begin(), lhs.end()) == std::vector<int>(rhs.begin(), rhs.end())));
+        for (const std::string& query : {"кот скворец"s, "пёс модный -хвост"s, "ошейник номер7"s, "и номер12"s}) {
+            for (const DocumentStatus status : {DocumentStatus::ACTUAL, DocumentStatus::BANNED}) {
+                AssertSameDocuments(rhs.FindTopDocuments(query, status), lhs.FindTopDocuments(query, status));
+            }
+        }
+        for (const int id : std::vector<int>(lhs.begin(), std::next(lhs.begin(), 50))) {
+            ASSERT(lhs.GetWordFrequencies(id) == rhs.GetWordFrequencies(id));
+            ASSERT(lhs.MatchDocument("кот модный"s, id) == rhs.MatchDocument("кот модный"s, id));
+        }
+    };
+    check(server, loaded);
+
+    server.AddDocument(100000, "модный скворец"s, DocumentStatus::ACTUAL, {5});
+    loaded.AddDocument(100000, "модный скворец"s, DocumentStatus::ACTUAL, {5});
+    server.RemoveDocument(4);
+    loaded.RemoveDocument(4);
+    loaded.MergeSegments();
+    check(server, loaded);
+
+    loaded.Save(path);
+    SearchServer reloaded = SearchServer::Load(path);
+    reloaded.Save(path);
+    check(loaded, reloaded);
+    check(reloaded, SearchServer::Load(path));
+    ASSERT(!std::ifstream(path + ".tmp"s));
+
+    std::string bytes;
+    {
+        std::ifstream input(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+    bytes[bytes.size() / 2] ^= 1;
+    {
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        output.write(bytes.data(), bytes.size());
+    }
+    try {
+        // Сегменты проверяются при первом обращении, поэтому ошибка может проявиться уже в запросе
+        SearchServer::Load(path).FindTopDocuments(std::execution::par, "кот скворец"s);
+        ASSERT_HINT(false, "corrupted index must throw"s);
+    } catch (const std::runtime_error&) {
+    }
+    std::remove(path.c_str());
+    try {
+        SearchServer::Load(path);
+        ASSERT_HINT(false, "missing index must throw"s);
+    } catch (const std::runtime_error&) {
+    }
+}
+
+void TestIndexSegmentValidation() {
+    IndexSegment segment(100);
+    for (int document_index = 100; document_index < 500; ++document_index) {
+        segment.Add(document_index, 1, 1 + document_index % 3, 0.5);
+        if (document_index % 7 == 0) {
+            segment.Add(document_index, 4, 2, 0.25);
+        }
+    }
+    segment.Seal(500);
+    const std::string_view data = segment.GetData();
+    const auto attach = [](const std::vector<uint64_t>& words, size_t size) {
+        auto storage = std::make_shared<std::vector<uint64_t>>(words);
+        const char* data = reinterpret_cast<const char*>(storage->data());
+        Checksum checksum;
+        checksum.Update(data, size);
+        return IndexSegment::FromData(storage, std::string_view(data, size), checksum.Get());
+    };
+    std::vector<uint64_t> words(data.size() / sizeof(uint64_t));
+    std::memcpy(words.data(), data.data(), data.size());
+    const IndexSegment copy = attach(words, data.size());
+    ASSERT_EQUAL(copy.Find(1).size(), 400u);
+    ASSERT_EQUAL(copy.Find(4).size(), 57u);
+
+    const size_t header_words = 6;
+    const size_t entries_word = header_words + 1;
+    const size_t entry_words = 6;
+    const auto expect_rejected = [&](size_t word, uint64_t value) {
+        std::vector<uint64_t> corrupted = words;
+        corrupted[word] = value;
+        try {
+            attach(corrupted, data.size()).Find(4);
+            ASSERT_HINT(false, "corrupted segment must throw"s);
+        } catch (const std::runtime_error&) {
+        }
+    };
+    expect_rejected(entries_word, 1000);
+    expect_rejected(entries_word + 1, 1u << 30);
+    expect_rejected(entries_word + 3, 401);
+    expect_rejected(entries_word + entry_words + 2, 2);
+    expect_rejected(header_words, uint64_t{4} | uint64_t{1} << 32);
+
+    std::vector<uint64_t> corrupted = words;
+    corrupted.back() ^= 1;
+    auto storage = std::make_shared<std::vector<uint64_t>>(corrupted);
+    const IndexSegment mismatched = IndexSegment::FromData(storage, std::string_view(reinterpret_cast<const char*>(storage->data()), data.size()), segment.GetChecksum());
+    try {
+        mismatched.Find(1);
+        ASSERT_HINT(false, "segment with wrong checksum must throw"s);
+    } catch (const std::runtime_error&) {
+    }
+}
+
+void TestLoadDocuments() {
+    const std::vector<std::string> words = {"кот"s, "пёс"s, "хвост"s, "ошейник"s, "скворец"s, "модный"s};
+    std::string dump;
+    SearchServer reference("и в на"s);
+    std::vector<size_t> bad_lines;
+    size_t line_number = 0;
+    for (int id = 0; id < static_cast<int>(LOADER_BATCH_SIZE) + 900; ++id) {
+        std::string text;
+        for (size_t i = 0; i < words.size(); ++i) {
+            if ((id * 3 + i) % (i + 2) == 0) {
+                text += words[i] + " "s;
+            }
+        }
+        text += "номер"s + std::to_string(id % 50);
+        const DocumentStatus status = id % 7 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+        dump += std::to_string(id) + (status == DocumentStatus::BANNED ? "\tBANNED\t"s : "\t0\t"s) + std::to_string(id % 10) + " -3\t"s + text + "\n"s;
+        ++line_number;
+        reference.AddDocument(id, text, status, {id % 10, -3});
+        if (id % 1000 == 500) {
+            dump += "\n"s + std::to_string(id) + "\t0\t1\tдубликат\n"s + "x\t0\t1\tкот\n"s + "7\tSTALE\t1\tкот\n"s + "8\t0\t1,2\tкот\n"s + "-5\t0\t1\tкот\n"s + "9\t0\tкот\n"s;
+            for (size_t i = 2; i <= 7; ++i) {
+                bad_lines.push_back(line_number + i);
+            }
+            line_number += 7;
+        }
+    }
+
+    const auto check = [&](const SearchServer& server, const LoadReport& report) {
+        ASSERT_EQUAL(report.document_count, static_cast<size_t>(reference.GetDocumentCount()));
+        ASSERT_EQUAL(server.GetDocumentCount(), reference.GetDocumentCount());
+        std::vector<size_t> error_lines;
+        for (const LoadError& error : report.errors) {
+            error_lines.push_back(error.line_number);
+        }
+        std::sort(error_lines.begin(), error_lines.end());
+        ASSERT(error_lines == bad_lines);
+        for (const std::string& query : {"кот скворец"s, "пёс модный -хвост"s, "ошейник номер7"s}) {
+            for (const DocumentStatus status : {DocumentStatus::ACTUAL, DocumentStatus::BANNED}) {
+                const auto found = server.FindTopDocuments(query, status);
+                const auto expected = reference.FindTopDocuments(query, status);
+                ASSERT_EQUAL(found.size(), expected.size());
+                for (size_t i = 0; i < found.size(); ++i) {
+                    ASSERT_EQUAL(found[i].id, expected[i].id);
+                    ASSERT_EQUAL(found[i].rating, expected[i].rating);
+                }
+            }
+        }
+    };
+
+    {
+        SearchServer server("и в на"s);
+        std::istringstream input(dump);
+        check(server, LoadDocuments(server, input));
+    }
+    {
+        const std::string path = "search_server_test.tsv"s;
+        {
+            std::ofstream output(path, std::ios::binary | std::ios::trunc);
+            output << dump;
+        }
+        SearchServer server("и в на"s);
+        check(server, LoadDocuments(server, path));
+        std::remove(path.c_str());
+    }
+}
+
+void TestRemoveDuplicates() {
+    const auto make_server = [] {
+        SearchServer server("и в на"s);
+        server.AddDocument(1, "пушистый кот пушистый хвост"s, DocumentStatus::ACTUAL, {7, 2, 7});
+        server.AddDocument(2, "пушистый пёс и модный ошейник"s, DocumentStatus::ACTUAL, {1, 2});
+        server.AddDocument(3, "хвост кот пушистый"s, DocumentStatus::BANNED, {1});
+        server.AddDocument(4, "модный ошейник пёс пушистый"s, DocumentStatus::ACTUAL, {3});
+        server.AddDocument(5, "кот пушистый"s, DocumentStatus::ACTUAL, {4});
+        server.AddDocument(6, "кот и в на пушистый хвост"s, DocumentStatus::ACTUAL, {5});
+        for (int id = 10; id < 3000; ++id) {
+            server.AddDocument(id, "слово"s + std::to_string(id % 1000) + " другое"s + std::to_string(id % 5), DocumentStatus::ACTUAL, {1});
+        }
+        return server;
+    };
+    std::vector<int> expected = {1, 2, 5};
+    for (int id = 10; id < 1010; ++id) {
+        expected.push_back(id);
+    }
+
+    std::ostringstream sink;
+    std::streambuf* const cout_buffer = std::cout.rdbuf(sink.rdbuf());
+    SearchServer sequential = make_server();
+    SearchServer parallel = make_server();
+    RemoveDuplicates(std::execution::seq, sequential);
+    RemoveDuplicates(std::execution::par, parallel);
+    std::cout.rdbuf(cout_buffer);
+
+    ASSERT((std::vector<int>(sequential.begin(), sequential.end()) == expected));
+    ASSERT((std::vector<int>(parallel.begin(), parallel.end()) == expected));
+    ASSERT_EQUAL(sink.str().rfind("Found duplicate document id 3\nFound duplicate document id 4\nFound duplicate document id 6\n"s, 0), 0);
+
+    SearchServer server = make_server();
+    DuplicateDetector detector(server);
+    ASSERT(detector.AddDocument(7, "хвост пушистый кот кот"s, DocumentStatus::ACTUAL, {1}) == std::optional<int>(1));
+    ASSERT(!detector.AddDocument(8, "хвост кот"s, DocumentStatus::ACTUAL, {1}));
+    ASSERT(detector.AddDocument(3000, "слово5 другое0"s, DocumentStatus::ACTUAL, {1}) == std::optional<int>(1005));
+    detector.RemoveDocument(7);
+    detector.RemoveDocument(1);
+    ASSERT(detector.AddDocument(9, "кот хвост пушистый"s, DocumentStatus::ACTUAL, {1}) == std::optional<int>(3));
+    detector.RemoveDocument(3);
+    detector.RemoveDocument(6);
+    ASSERT(detector.AddDocument(3001, "пушистый кот хвост"s, DocumentStatus::ACTUAL, {1}) == std::optional<int>(9));
+    server.RemoveDocument(9);
+    ASSERT(detector.AddDocument(3002, "хвост пушистый кот"s, DocumentStatus::ACTUAL, {1}) == std::optional<int>(3001));
+    server.RemoveDocument(3001);
+    server.RemoveDocument(3002);
+    ASSERT(!detector.AddDocument(3003, "кот пушистый хвост"s, DocumentStatus::ACTUAL, {1}));
+    server.RemoveDocument(8);
+    server.AddDocument(8, "модный ошейник"s, DocumentStatus::ACTUAL, {1});
+    ASSERT(!detector.AddDocument(3004, "кот хвост"s, DocumentStatus::ACTUAL, {1}));
+    ASSERT(detector.AddDocument(3005, "хвост кот"s, DocumentStatus::ACTUAL, {1}) == std::optional<int>(3004));
+}
+
+void TestNearDuplicates() {
+    const auto make_text = [](int seed, int changed_word) {
+        std::string text;
+        for (int i = 0; i < 20; ++i) {
+            text += "слово"s + std::to_string(seed * 100 + (i == changed_word ? 50 + i : i)) + " "s;
+        }
+        return text;
+    };
+    const auto make_server = [&make_text] {
+        SearchServer server("и в на"s);
+        for (int id = 0; id < 300; ++id) {
+            server.AddDocument(id, make_text(id, -1), DocumentStatus::ACTUAL, {1});
+        }
+        server.AddDocument(1000, make_text(7, 3), DocumentStatus::ACTUAL, {5});
+        server.AddDocument(1001, make_text(7, 11) + "и на"s, DocumentStatus::ACTUAL, {3});
+        server.AddDocument(1002, make_text(42, 0), DocumentStatus::ACTUAL, {0});
+        server.AddDocument(1003, make_text(42, -1) + "лишнее другое третье четвёртое пятое шестое"s, DocumentStatus::ACTUAL, {9});
+        return server;
+    };
+    const std::vector<std::vector<int>> expected = {{7, 1000, 1001}, {42, 1002}};
+
+    const SearchServer server = make_server();
+    ASSERT(FindNearDuplicates(server) == expected);
+    ASSERT(FindNearDuplicates(std::execution::par, server) == expected);
+    const std::vector<std::vector<int>> loose = {{7, 1000, 1001}, {42, 1002, 1003}};
+    ASSERT(FindNearDuplicates(std::execution::par, server, 0.6) == loose);
+    ASSERT(FindNearDuplicates(server, 1.0).empty());
+    try {
+        FindNearDuplicates(server, 1.5);
+        ASSERT_HINT(false, "invalid threshold must throw"s);
+    } catch (const std::invalid_argument&) {
+    }
+
+    std::ostringstream sink;
+    std::streambuf* const cout_buffer = std::cout.rdbuf(sink.rdbuf());
+    SearchServer cleaned = make_server();
+    RemoveNearDuplicates(std::execution::par, cleaned);
+    std::cout.rdbuf(cout_buffer);
+    ASSERT_EQUAL(cleaned.GetDocumentCount(), 301);
+    ASSERT_EQUAL(sink.str(), "Found near duplicate document id 7\nFound near duplicate document id 1001\nFound near duplicate document id 1002\n"s);
+}
+
+void TestRemoveDocuments() {
+    const std::vector<std::string> words = {"кот"s, "пёс"s, "хвост"s, "ошейник"s, "скворец"s, "модный"s};
+    const int document_count = 2 * SEGMENT_SEAL_SIZE + 300;
+    const auto make_text = [&words](int id) {
+        std::string text;
+        for (size_t i = 0; i < words.size(); ++i) {
+            if ((id * 3 + i) % (i + 2) == 0) {
+                text += words[i] + " "s;
+            }
+        }
+        return text + "номер"s + std::to_string(id % 40) + (id % 500 == 0 ? " редкое"s : ""s);
+    };
+    const auto is_removed = [](int id) {
+        return id < SEGMENT_SEAL_SIZE - 100 || id % 5 == 0;
+    };
+    std::vector<int> removed_ids = {-1, document_count + 10};
+    SearchServer reference("и в на"s);
+    for (int id = 0; id < document_count; ++id) {
+        if (is_removed(id)) {
+            removed_ids.push_back(id);
+        } else {
+            reference.AddDocument(id, make_text(id), DocumentStatus::ACTUAL, {id % 11});
+        }
+    }
+    removed_ids.push_back(5);
+    std::reverse(removed_ids.begin(), removed_ids.end());
+
+    const auto check = [&reference](const SearchServer& server) {
+        ASSERT_EQUAL(server.GetDocumentCount(), reference.GetDocumentCount());
+        ASSERT((std::vector<int>(server.begin(), server.end()) == std::vector<int>(reference.begin(), reference.end())));
+        for (const std::string& query : {"кот скворец"s, "пёс модный -хвост"s, "ошейник номер7"s, "редкое"s, "номер3 -редкое"s}) {
+            const auto found = server.FindTopDocuments(query);
+            const auto expected = reference.FindTopDocuments(query);
+            ASSERT_EQUAL(found.size(), expected.size());
+            for (size_t i = 0; i < found.size(); ++i) {
+                ASSERT_EQUAL(found[i].id, expected[i].id);
+                ASSERT(std::abs(found[i].relevance - expected[i].relevance) < EPSILON);
+            }
+        }
+    };
+
+    SearchServer sequential("и в на"s);
+    SearchServer parallel("и в на"s);
+    for (int id = 0; id < document_count; ++id) {
+        sequential.AddDocument(id, make_text(id), DocumentStatus::ACTUAL, {id % 11});
+        parallel.AddDocument(id, make_text(id), DocumentStatus::ACTUAL, {id % 11});
+    }
+    sequential.RemoveDocuments(std::execution::seq, removed_ids);
+    parallel.RemoveDocuments(std::execution::par, removed_ids);
+    check(sequential);
+    check(parallel);
+    parallel.RemoveDocuments(std::execution::par, {});
+    parallel.RemoveDocuments(std::execution::par, removed_ids);
+    check(parallel);
+
+    parallel.AddDocument(document_count, "редкое новое"s, DocumentStatus::ACTUAL, {1});
+    reference.AddDocument(document_count, "редкое новое"s, DocumentStatus::ACTUAL, {1});
+    check(parallel);
+    parallel.MergeSegments();
+    check(parallel);
+}
+
+void TestCollectionStatistics() {
+    SearchServer server("и в на"s);
+    server.AddDocument(1, "пушистый кот пушистый хвост"s, DocumentStatus::ACTUAL, {7, 2, 7});
+    server.AddDocument(2, "пушистый пёс и модный ошейник"s, DocumentStatus::ACTUAL, {1, 2});
+    server.AddDocument(3, "ухоженный скворец"s, DocumentStatus::BANNED, {1});
+    server.AddDocument(4, "ухоженный пёс"s, DocumentStatus::ACTUAL, {3});
+
+    const CollectionStatistics& statistics = server.GetCollectionStatistics();
+    ASSERT_EQUAL(statistics.GetDocumentCount(), 4);
+    TermStatistics term_statistics = server.GetTermStatistics("пёс"s);
+    ASSERT_EQUAL(term_statistics.document_freq, 2u);
+    ASSERT(std::abs(term_statistics.inverse_document_freq - std::log(4.0 / 2)) < EPSILON);
+    ASSERT_EQUAL(server.GetTermStatistics("и"s).document_freq, 0u);
+    ASSERT_EQUAL(server.GetTermStatistics("слон"s).document_freq, 0u);
+
+    const uint64_t generation = statistics.GetGeneration();
+    const auto found = server.FindTopDocuments("пушистый пёс"s);
+    ASSERT_EQUAL(statistics.GetGeneration(), generation);
+    server.AddDocument(5, "пёс"s, DocumentStatus::ACTUAL, {1});
+    ASSERT(statistics.GetGeneration() > generation);
+    term_statistics = server.GetTermStatistics("пёс"s);
+    ASSERT_EQUAL(term_statistics.document_freq, 3u);
+    ASSERT(std::abs(term_statistics.inverse_document_freq - std::log(5.0 / 3)) < EPSILON);
+    ASSERT(std::abs(server.GetTermStatistics("пушистый"s).inverse_document_freq - std::log(5.0 / 2)) < EPSILON);
+
+    server.RemoveDocuments({2, 4});
+    ASSERT_EQUAL(statistics.GetDocumentCount(), 3);
+    ASSERT(std::abs(server.GetTermStatistics("пёс"s).inverse_document_freq - std::log(3.0 / 1)) < EPSILON);
+    ASSERT_EQUAL(server.GetTermStatistics("ошейник"s).document_freq, 0u);
+    const auto relevance = server.FindTopDocuments("пёс"s).at(0).relevance;
+    ASSERT(std::abs(relevance - std::log(3.0)) < EPSILON);
+}
+
+void TestForwardIndex() {
+    SearchServer server("и в на"s);
+    server.AddDocument(1, "пушистый кот пушистый хвост"s, DocumentStatus::ACTUAL, {7, 2, 7});
+    server.AddDocument(2, "модный пёс и модный ошейник"s, DocumentStatus::ACTUAL, {1, 2});
+
+    const WordFrequencies frequencies = server.GetWordFrequencies(1);
+    ASSERT_EQUAL(frequencies.size(), 3u);
+    ASSERT(std::abs(frequencies.at("пушистый"s) - 0.5) < EPSILON);
+    ASSERT(std::abs(frequencies.at("хвост"s) - 0.25) < EPSILON);
+    double total = 0.0;
+    for (const auto [word, freq] : frequencies) {
+        ASSERT(word != "и"s);
+        total += freq;
+    }
+    ASSERT(std::abs(total - 1.0) < EPSILON);
+    ASSERT(server.GetWordFrequencies(100).empty());
+    try {
+        frequencies.at("ошейник"s);
+        ASSERT_HINT(false, "Expected out_of_range"s);
+    } catch (const std::out_of_range&) {
+    }
+
+    for (const auto& match : {server.MatchDocument("хвост кот слон"s, 1), server.MatchDocument(std::execution::par, "хвост кот слон"s, 1)}) {
+        ASSERT(std::get<0>(match) == std::vector<std::string_view>({"кот", "хвост"}));
+    }
+    ASSERT(std::get<0>(server.MatchDocument(std::execution::par, "хвост -кот"s, 1)).empty());
+    ASSERT(std::get<0>(server.MatchDocument("пёс -кот"s, 2)) == std::vector<std::string_view>({"пёс"}));
+
+    for (int id = 3; id < 200; ++id) {
+        server.AddDocument(id, "кот номер "s + std::to_string(id), DocumentStatus::ACTUAL, {id});
+    }
+    const size_t term_count = server.GetWordFrequencies(1).GetTerms().size();
+    for (int id = 3; id < 200; ++id) {
+        server.RemoveDocument(id);
+    }
+    ASSERT_EQUAL(server.GetWordFrequencies(1).GetTerms().size(), term_count);
+    ASSERT(std::abs(server.GetWordFrequencies(2).at("модный"s) - 0.5) < EPSILON);
+    ASSERT(std::get<0>(server.MatchDocument("хвост пёс"s, 2)) == std::vector<std::string_view>({"пёс"}));
+}
+
+void TestMatchDocuments() {
+    SearchServer server("и в на"s);
+    const std::vector<std::string> words = {"кот"s, "пёс"s, "хвост"s, "ошейник"s, "скворец"s, "модный"s, "пушистый"s};
+    const int document_count = 20000;
+    for (int id = 0; id < document_count; ++id) {
+        std::string text;
+        for (size_t i = 0; i < words.size(); ++i) {
+            if ((id * 7 + i * 3) % (i + 2) == 0) {
+                text += words[i] + " "s;
+            }
+        }
+        server.AddDocument(id * 2, text + "документ"s, id % 5 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL, {id % 9});
+    }
+    std::vector<int> removed_ids;
+    for (int id = 0; id < document_count; id += 7) {
+        removed_ids.push_back(id * 2);
+    }
+    server.RemoveDocuments(removed_ids);
+
+    const auto check = [&server](const MatchedDocuments& matched_documents, const std::string& query, const std::vector<int>& document_ids) {
+        ASSERT_EQUAL(matched_documents.size(), document_ids.size());
+        for (size_t i = 0; i < document_ids.size(); ++i) {
+            const auto [expected_words, expected_status] = server.MatchDocument(query, document_ids[i]);
+            const auto matched_words = matched_documents.GetWords(i);
+            ASSERT_EQUAL(matched_documents.GetDocumentId(i), document_ids[i]);
+            ASSERT(matched_documents.GetStatus(i) == expected_status);
+            ASSERT(std::vector<std::string_view>(matched_words.begin(), matched_words.end()) == expected_words);
+        }
+    };
+    const std::vector<int> all_ids(server.begin(), server.end());
+    const std::vector<int> some_ids = {30, 2, 30, 4000, 3998};
+    for (const std::string& query : {"пушистый кот модный"s, "хвост ошейник -пёс"s, "скворец -документ"s, "слон"s, "-кот пушистый пушистый"s}) {
+        check(server.MatchDocuments(query), query, all_ids);
+        check(server.MatchDocuments(std::execution::par, query), query, all_ids);
+        check(server.MatchDocuments(query, some_ids), query, some_ids);
+        check(server.MatchDocuments(std::execution::par, query, some_ids), query, some_ids);
+    }
+    ASSERT(server.MatchDocuments("кот"s, {}).empty());
+
+    try {
+        server.MatchDocuments("кот"s, {1, 0});
+        ASSERT_HINT(false, "Expected out_of_range"s);
+    } catch (const std::out_of_range&) {
+    }
+    try {
+        server.MatchDocuments(std::execution::par, "кот --пёс"s);
+        ASSERT_HINT(false, "Expected invalid_argument"s);
+    } catch (const std::invalid_argument&) {
+    }
+}
+
+void TestDocumentFilters() {
+    {
+        SearchServer server("и в на"s);
+        server.AddDocument(1, "белый кот"s,     DocumentStatus::ACTUAL,     {8});
+        server.AddDocument(2, "пушистый кот"s,  DocumentStatus::BANNED,     {2});
+        server.AddDocument(3, "ухоженный кот"s, DocumentStatus::ACTUAL,     {5});
+        server.AddDocument(4, "кот и пёс"s,     DocumentStatus::IRRELEVANT, {-1});
+        const auto banned = server.FindTopDocuments("белый ухоженный кот"s, DocumentStatusFilter{DocumentStatus::BANNED});
+        ASSERT_EQUAL(banned.size(), 1u);
+        ASSERT_EQUAL(banned[0].id, 2);
+        ASSERT(std::abs(banned[0].relevance) < EPSILON);
+        const auto any = server.FindTopDocuments("белый ухоженный кот"s, AnyDocumentFilter{});
+        ASSERT_EQUAL(any.size(), 4u);
+        ASSERT_EQUAL(any[0].id, 1);
+        ASSERT_EQUAL(any[1].id, 3);
+        ASSERT(std::abs(any[1].relevance - 0.693147) < EPSILON);
+        ASSERT_EQUAL(any[2].id, 2);
+        ASSERT_EQUAL(any[3].id, 4);
+    }
+
+    SearchServer server("и в на"s);
+    const std::vector<DocumentStatus> statuses = {DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT, DocumentStatus::BANNED, DocumentStatus::REMOVED};
+    for (int id = 0; id < 3000; ++id) {
+        std::string text = "кот"s;
+        if (id % 11 == 0) {
+            text += " пушистый"s;
+        }
+        if (id % 3 == 0) {
+            text += " хвост"s;
+        }
+        server.AddDocument(id, text, statuses[id % 7 == 0 ? 1 : id % 5 == 0 ? 2 : 0], {id % 13});
+    }
+    std::vector<int> removed_ids;
+    for (int id = 0; id < 3000; id += 4) {
+        removed_ids.push_back(id);
+    }
+    server.RemoveDocuments(removed_ids);
+    server.RemoveDocument(1);
+
+    for (const std::string& query : {"кот пушистый"s, "кот хвост -пушистый"s, "пушистый"s}) {
+        for (const DocumentStatus status : statuses) {
+            const auto predicate = [status](int, DocumentStatus document_status, int) {
+                return document_status == status;
+            };
+            AssertSameDocuments(server.FindTopDocuments(query, status, 20), server.FindTopDocuments(query, predicate, 20));
+            AssertSameDocuments(server.FindTopDocuments(std::execution::par, query, status, 20), server.FindTopDocuments(query, predicate, 20));
+        }
+        const auto any_document = [](int, DocumentStatus, int) {
+            return true;
+        };
+        AssertSameDocuments(server.FindTopDocuments(query, AnyDocumentFilter{}, 20), server.FindTopDocuments(query, any_document, 20));
+        AssertSameDocuments(server.FindTopDocuments(std::execution::par, query, AnyDocumentFilter{}, 20), server.FindTopDocuments(query, any_document, 20));
+    }
+    ASSERT(server.FindTopDocuments("кот"s, DocumentStatus::REMOVED).empty());
+
+    const std::string path = "search_server_filters_test.idx"s;
+    server.Save(path);
+    const SearchServer loaded = SearchServer::Load(path);
+    std::remove(path.c_str());
+    for (const DocumentStatus status : statuses) {
+        AssertSameDocuments(loaded.FindTopDocuments("кот пушистый"s, status, 20), server.FindTopDocuments("кот пушистый"s, status, 20));
+    }
+}
+
+void TestDocumentFilterIndexes() {
+    {
+        SearchServer server("и в на"s);
+        server.AddDocument(1, "белый кот"s,     DocumentStatus::ACTUAL,     {8});
+        server.AddDocument(2, "пушистый кот"s,  DocumentStatus::BANNED,     {2});
+        server.AddDocument(3, "ухоженный кот"s, DocumentStatus::ACTUAL,     {5});
+        server.AddDocument(4, "кот и пёс"s,     DocumentStatus::IRRELEVANT, {-1});
+        DocumentFilter filter;
+        filter.min_rating = 3;
+        auto found = server.FindTopDocuments("белый ухоженный кот"s, filter);
+        ASSERT_EQUAL(found.size(), 2u);
+        ASSERT_EQUAL(found[0].id, 1);
+        ASSERT_EQUAL(found[1].id, 3);
+        filter = DocumentFilter{};
+        filter.statuses = {DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT};
+        filter.max_rating = 5;
+        found = server.FindTopDocuments("белый ухоженный кот"s, filter);
+        ASSERT_EQUAL(found.size(), 2u);
+        ASSERT_EQUAL(found[0].id, 3);
+        ASSERT_EQUAL(found[1].id, 4);
+        filter = DocumentFilter{};
+        filter.min_document_id = 2;
+        filter.max_document_id = 3;
+        found = server.FindTopDocuments("белый ухоженный кот"s, filter);
+        ASSERT_EQUAL(found.size(), 2u);
+        ASSERT_EQUAL(found[0].id, 3);
+        ASSERT_EQUAL(found[1].id, 2);
+        filter.min_rating = 9;
+        ASSERT(server.FindTopDocuments("белый ухоженный кот"s, filter).empty());
+        server.RemoveDocument(3);
+        filter = DocumentFilter{};
+        filter.min_rating = 3;
+        found = server.FindTopDocuments("белый ухоженный кот"s, filter);
+        ASSERT_EQUAL(found.size(), 1u);
+        ASSERT_EQUAL(found[0].id, 1);
+    }
+
+    SearchServer server("и в на"s);
+    const std::vector<DocumentStatus> statuses = {DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT, DocumentStatus::BANNED, DocumentStatus::REMOVED};
+    for (int id = 0; id < 20000; ++id) {
+        std::string text = "кот"s;
+        if (id % 9 == 0) {
+            text += " пушистый"s;
+        }
+        if (id % 2 == 0) {
+            text += " хвост"s;
+        }
+        server.AddDocument(id * 3, text, statuses[id % 7 == 0 ? 2 : id % 3], {id % 100, id % 17});
+    }
+    std::vector<int> removed_ids;
+    for (int id = 0; id < 20000; id += 5) {
+        removed_ids.push_back(id * 3);
+    }
+    server.RemoveDocuments(removed_ids);
+
+    std::vector<DocumentFilter> filters(7);
+    filters[1].min_rating = 55;
+    filters[2].min_document_id = 3000;
+    filters[2].max_document_id = 3100;
+    filters[2].statuses = {DocumentStatus::ACTUAL, DocumentStatus::BANNED};
+    filters[3].statuses = {DocumentStatus::IRRELEVANT};
+    filters[3].min_rating = 10;
+    filters[4].min_rating = 30;
+    filters[4].max_rating = 20;
+    filters[5].min_document_id = 59500;
+    filters[6].statuses = {DocumentStatus::REMOVED};
+    for (const std::string& query : {"кот пушистый"s, "хвост -пушистый"s, "кот"s}) {
+        for (const DocumentFilter& filter : filters) {
+            const auto predicate = [&filter](int document_id, DocumentStatus status, int rating) {
+                return filter(document_id, status, rating);
+            };
+            const std::vector<Document> expected = server.FindTopDocuments(query, predicate, 10);
+            AssertSameDocuments(server.FindTopDocuments(query, filter, 10), expected);
+            AssertSameDocuments(server.FindTopDocuments(std::execution::par, query, filter, 10), expected);
+        }
+    }
+    ASSERT(server.FindTopDocuments("кот"s, filters[4]).empty());
+    ASSERT(server.FindTopDocuments("кот"s, filters[6]).empty());
+
+    const std::string path = "search_server_filter_indexes_test.idx"s;
+    server.Save(path);
+    const SearchServer loaded = SearchServer::Load(path);
+    std::remove(path.c_str());
+    for (const DocumentFilter& filter : filters) {
+        AssertSameDocuments(loaded.FindTopDocuments("кот пушистый"s, filter, 10), server.FindTopDocuments("кот пушистый"s, filter, 10));
+    }
+}
+
+void TestRatingIndex() {
+    RatingIndex index;
+    std::vector<bool> is_removed(1000);
+    for (int document_index = 0; document_index < 1000; ++document_index) {
+        index.Add(document_index % 10, document_index);
+    }
+    ASSERT_EQUAL(index.CountInRange(2, 3), 200u);
+    ASSERT_EQUAL(index.CountInRange(5, 4), 0u);
+    int rating_sum = 0;
+    index.ForEachInRange(9, 100, [&rating_sum](int document_index) {
+        rating_sum += document_index % 10;
+    });
+    ASSERT_EQUAL(rating_sum, 900);
+
+    for (int document_index = 0; document_index < 600; ++document_index) {
+        is_removed[document_index] = true;
+        index.Remove([&is_removed](int removed_index) {
+            return is_removed[removed_index];
+        });
+    }
+    ASSERT_EQUAL(index.CountInRange(0, 0), 49u);
+    index.ForEachInRange(0, 9, [](int document_index) {
+        ASSERT(document_index > 500);
+    });
+}
+
 void TestSearchServer() {
     TestAddAndFindDocument();
     TestExclusionOfStopWords();
@@ -119,4 +1396,33 @@ void TestSearchServer() {
     TestFilteringByPredicate();
     TestSearchByStatus();
     TestCalculatingRelevance();
+    TestAddAndRemoveInAnyOrder();
+    TestTermReuseAfterRemove();
+    TestReleasedTermRecycling();
+    TestTopDocumentsCount();
+    TestRelevanceAccumulator();
+    TestPrunedSearchMatchesExhaustive();
+    TestPostingListCompression();
+    TestSplitIntoWords();
+    TestParallelSearchMatchesSequential();
+    TestConcurrentMap();
+    TestProcessQueries();
+    TestQueryCache();
+    TestConcurrentSearchServer();
+    TestConcurrentSearchServerTrimsLog();
+    TestSegmentedIndex();
+    TestDocumentIndexCompaction();
+    TestAddDocuments();
+    TestSaveLoad();
+    TestIndexSegmentValidation();
+    TestLoadDocuments();
+    TestRemoveDuplicates();
+    TestNearDuplicates();
+    TestRemoveDocuments();
+    TestCollectionStatistics();
+    TestForwardIndex();
+    TestMatchDocuments();
+    TestDocumentFilters();
+    TestDocumentFilterIndexes();
+    TestRatingIndex();
 }
\ No newline at end of file
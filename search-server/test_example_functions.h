@@ -6,10 +6,27 @@
 #include <cmath>
 #include <cstdlib>
 #include <iomanip>
+#include <map>
+#include <atomic>
+#include <thread>
+#include <numeric>
+#include <algorithm>
+#include <execution>
+#include <fstream>
+#include <cstdio>
+#include <iterator>
+#include <sstream>
 
 
 #include "document.h"
 #include "search_server.h"
+#include "concurrent_map.h"
+#include "process_queries.h"
+#include "query_cache.h"
+#include "concurrent_search_server.h"
+#include "document_loader.h"
+#include "remove_duplicates.h"
+#include "near_duplicates.h"
 
 
 using std::literals::string_literals::operator""s;
@@ -36,6 +53,8 @@ void AssertEqualImpl(const T& t, const U& u, const std::string& t_str, const std
 
 void AssertImpl(bool value, const std::string& expr_str, const std::string& file, const std::string& func, unsigned line, const std::string& hint);
 
+void AssertSameDocuments(const std::vector<Document>& lhs, const std::vector<Document>& rhs);
+
 #define ASSERT(expr) AssertImpl(expr, #expr, __FILE__, __FUNCTION__, __LINE__, ""s)
 
 #define ASSERT_HINT(expr, hint) AssertImpl(expr, #expr, __FILE__, __FUNCTION__, __LINE__, hint)
@@ -48,4 +67,33 @@ void TestComputeRating();
 void TestFilteringByPredicate();
 void TestSearchByStatus();
 void TestCalculatingRelevance();
+void TestAddAndRemoveInAnyOrder();
+void TestTermReuseAfterRemove();
+void TestReleasedTermRecycling();
+void TestTopDocumentsCount();
+void TestRelevanceAccumulator();
+void TestPrunedSearchMatchesExhaustive();
+void TestPostingListCompression();
+void TestSplitIntoWords();
+void TestParallelSearchMatchesSequential();
+void TestConcurrentMap();
+void TestProcessQueries();
+void TestQueryCache();
+void TestConcurrentSearchServer();
+void TestConcurrentSearchServerTrimsLog();
+void TestSegmentedIndex();
+void TestDocumentIndexCompaction();
+void TestAddDocuments();
+void TestSaveLoad();
+void TestIndexSegmentValidation();
+void TestLoadDocuments();
+void TestRemoveDuplicates();
+void TestNearDuplicates();
+void TestRemoveDocuments();
+void TestCollectionStatistics();
+void TestForwardIndex();
+void TestMatchDocuments();
+void TestDocumentFilters();
+void TestDocumentFilterIndexes();
+void TestRatingIndex();
 void TestSearchServer();
\ No newline at end of file
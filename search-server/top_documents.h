@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "document.h"
+
+const double EPSILON = 1e-6;
+
+inline bool IsMoreRelevant(const Document& lhs, const Document& rhs) {
+    if (std::abs(lhs.relevance - rhs.relevance) < EPSILON) {
+        return lhs.rating == rhs.rating ? lhs.id < rhs.id : lhs.rating > rhs.rating;
+    }
+    return lhs.relevance > rhs.relevance;
+}
+
+class TopDocuments {
+public:
+    explicit TopDocuments(size_t top_count)
+        : top_count_(top_count) {
+        heap_.reserve(top_count);
+    }
+
+    void Add(const Document& document) {
+        if (heap_.size() < top_count_) {
+            heap_.push_back(document);
+            std::push_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+        } else if (top_count_ > 0 && IsMoreRelevant(document, heap_.front())) {
+            std::pop_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+            heap_.back() = document;
+            std::push_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+        }
+    }
+
+    bool CanEnter(double max_relevance) const {
+        return top_count_ > 0 && (heap_.size() < top_count_ || max_relevance > heap_.front().relevance - EPSILON);
+    }
+
+    void Merge(const TopDocuments& other) {
+        for (const Document& document : other.heap_) {
+            Add(document);
+        }
+    }
+
+    size_t size() const {
+        return heap_.size();
+    }
+
+    size_t ReleaseTo(Document* output) {
+        std::sort_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+        std::copy(heap_.begin(), heap_.end(), output);
+        const size_t count = heap_.size();
+        heap_.clear();
+        return count;
+    }
+
+    std::vector<Document> Release() {
+        std::sort_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+        return std::move(heap_);
+    }
+
+private:
+    size_t top_count_;
+    std::vector<Document> heap_;
+};
+
+inline std::vector<Document> SelectTopDocuments(std::vector<Document> documents, size_t top_count) {
+    if (documents.size() > top_count) {
+        std::nth_element(documents.begin(), documents.begin() + top_count, documents.end(), IsMoreRelevant);
+        documents.resize(top_count);
+    }
+    std::sort(documents.begin(), documents.end(), IsMoreRelevant);
+    return documents;
+}
+
+template <class ExecutionPolicy>
+std::vector<Document> SelectTopDocuments(ExecutionPolicy&& policy, std::vector<Document> documents, size_t top_count) {
+    if constexpr (std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy>) {
+        return SelectTopDocuments(std::move(documents), top_count);
+    } else {
+        const size_t chunk_count = std::max(1u, std::thread::hardware_concurrency());
+        if (chunk_count == 1 || documents.size() <= top_count * chunk_count) {
+            return SelectTopDocuments(std::move(documents), top_count);
+        }
+        const size_t chunk_size = (documents.size() + chunk_count - 1) / chunk_count;
+        std::vector<TopDocuments> chunk_tops(chunk_count, TopDocuments(top_count));
+        std::vector<size_t> chunks(chunk_count);
+        std::iota(chunks.begin(), chunks.end(), 0);
+        std::for_each(policy, chunks.begin(), chunks.end(), [&](size_t chunk) {
+            const size_t first = std::min(chunk * chunk_size, documents.size());
+            const size_t last = std::min(first + chunk_size, documents.size());
+            for (size_t i = first; i < last; ++i) {
+                chunk_tops[chunk].Add(documents[i]);
+            }
+        });
+        for (size_t chunk = 1; chunk < chunk_count; ++chunk) {
+            chunk_tops.front().Merge(chunk_tops[chunk]);
+        }
+        return chunk_tops.front().Release();
+    }
+}